@@ -2,9 +2,12 @@
 #include <debug.h>
 #include <inttypes.h>
 #include <round.h>
+#include <stddef.h>
 #include <stdio.h>
+#include "intrinsic.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
+#include "threads/loader.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
 
@@ -20,37 +23,93 @@
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
+/* ticks 갱신용 seqlock. timer_ticks()는 인터럽트를 끄지 않고 읽는다. */
+static struct seqlock ticks_seq;
+
+/* 8254 input frequency divided by TIMER_FREQ, rounded to nearest. */
+#define PIT_COUNT ((1193180 + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* Nanoseconds per timer tick. */
+#define NS_PER_TICK (1000000000 / TIMER_FREQ)
+
+/* TSC 클록소스. timer_calibrate()가 PIT 틱에 맞춰 보정하기 전에는
+   tsc_per_tick이 0이고, timer_ns()는 틱 단위 해상도로 동작한다. */
+static uint64_t tsc_per_tick; /* 한 틱 동안의 TSC cycle 수 */
+static uint64_t tsc_ns_mult;  /* ns = cycles * tsc_ns_mult >> 32 */
+static uint64_t tsc_base;	  /* 보정 시점의 TSC 값 */
+static int64_t ns_base;		  /* 보정 시점의 timer_ns() 값 */
+static uint64_t tsc_slop;	  /* 이만큼 이르게 온 인터럽트는 제때 온 것으로 본다 */
+
+/* -tickless: idle 중에는 PIT를 one-shot으로 돌려 필요한 틱에만 깨어난다. */
+bool timer_tickless;
+
+/* PIT 동작 모드. 평소에는 주기 모드로 매 틱 인터럽트를 받는다.
+   틱 경계 사이의 고해상도 sleep이 있거나 idle이 tickless로 대기하면
+   one-shot 모드로 바꾸고, 다음 할 일(틱 경계, sleep 만료)의 TSC 시각에
+   맞춰 매번 다시 건다. 틱 경계에서 더 이상 one-shot이 필요 없으면
+   주기 모드로 돌아간다. */
+static bool pit_oneshot_mode;
+static uint64_t last_tick_tsc; /* 주기 모드: 마지막 틱 인터럽트 시각 */
+static uint64_t next_tick_tsc; /* one-shot 모드: 다음 틱 경계 */
+static bool idle_tickless;	   /* idle 스레드가 tickless로 대기 중 */
+static bool in_clock_event;	   /* clock_event() 실행 중 */
+
+/* 한 틱보다 짧은 sleep 중인 스레드들, sleep_event.expires(TSC 마감 시각) 순.
+   이 스레드들의 sleep_event는 타이밍 휠 대신 여기에 들어간다. */
+static struct list hr_sleepers;
+
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
 static intr_handler_func timer_interrupt;
+static void timer_do_tick(bool user);
+static void pit_periodic(void);
+static void pit_oneshot(uint16_t count);
+static void clock_oneshot_start(void);
+static void clock_program(uint64_t now);
+static void clock_event(uint64_t now, bool user);
+static void hr_sleep(uint64_t cycles);
+static void tsc_calibrate(void);
+static int wheel_idle_ticks(int max);
 static bool too_many_loops(unsigned loops);
 static void busy_wait(int64_t loops);
 static void real_time_sleep(int64_t num, int32_t denom);
 
-/* sleep_list 선언*/
-static struct list sleep_list;
-/* sleep_list 비교함수 선언*/
-static bool wakeup_tick_less(const struct list_elem *a, const struct list_elem *b, void *aux);
+/* 계층형 타이밍 휠.
+   레벨 L의 슬롯 하나는 2^(6L) 틱 구간을 맡는다. 이벤트는 남은 시간에 맞는
+   레벨에 O(1)로 들어가고, 하위 레벨이 한 바퀴 돌 때마다 상위 레벨의 슬롯
+   하나가 아래로 내려온다(cascade). 레벨 0의 슬롯은 정확히 한 틱에 대응한다.
+   4 레벨이면 2^24 틱까지 표현하며, 그보다 먼 이벤트는 최상위 레벨에서
+   다시 내려올 때마다 재배치된다. */
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4
+#define WHEEL_SPAN ((int64_t)1 << (WHEEL_BITS * WHEEL_LEVELS))
+
+static struct list wheel[WHEEL_LEVELS][WHEEL_SIZE];
+static int64_t wheel_tick; /* 휠이 마지막으로 처리한 틱 */
+
+static void wheel_insert(struct timer_event *ev, int64_t first);
+static void wheel_advance(int64_t now);
+static void sleep_expired(struct timer_event *ev);
 
 /* Sets up the 8254 Programmable Interval Timer (PIT) to
    interrupt PIT_FREQ times per second, and registers the
    corresponding interrupt. */
 void timer_init(void)
 {
-	/* 8254 input frequency divided by TIMER_FREQ, rounded to
-	   nearest. */
-	uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
-
-	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
-	outb(0x40, count & 0xff);
-	outb(0x40, count >> 8);
+	pit_periodic();
+	seq_init(&ticks_seq);
 
 	intr_register_ext(0x20, timer_interrupt, "8254 Timer");
 
-	/* sleep_list 초기화*/
-	list_init(&sleep_list);
+	/* 타이밍 휠 초기화 */
+	for (int level = 0; level < WHEEL_LEVELS; level++)
+		for (int slot = 0; slot < WHEEL_SIZE; slot++)
+			list_init(&wheel[level][slot]);
+	list_init(&hr_sleepers);
 }
 
 /* Calibrates loops_per_tick, used to implement brief delays. */
@@ -77,15 +136,64 @@ void timer_calibrate(void)
 			loops_per_tick |= test_bit;
 
 	printf("%'" PRIu64 " loops/s.\n", (uint64_t)loops_per_tick * TIMER_FREQ);
+
+	tsc_calibrate();
+}
+
+/* PIT 틱을 기준으로 TSC 주파수를 잰다. TIMER_FREQ / 10 틱(100ms) 동안
+   늘어난 TSC를 세고, timer_ns()가 이어지도록 현재 시각을 기준점으로 삼는다. */
+static void
+tsc_calibrate(void)
+{
+	const int cal_ticks = TIMER_FREQ / 10;
+	uint32_t regs[4];
+	uint64_t start_tsc, per_tick;
+	int64_t start;
+	enum intr_level old_level;
+
+	/* 틱 경계에서 시작 */
+	start = ticks;
+	while (ticks == start)
+		barrier();
+	start_tsc = rdtsc();
+	start = ticks;
+	while (ticks < start + cal_ticks)
+		barrier();
+	per_tick = (rdtsc() - start_tsc) / cal_ticks;
+	if (per_tick == 0)
+		return;
+
+	old_level = intr_disable();
+	ns_base = ticks * NS_PER_TICK;
+	tsc_base = rdtsc();
+	tsc_ns_mult = ((uint64_t)NS_PER_TICK << 32) / per_tick;
+	tsc_slop = per_tick / 512;
+	last_tick_tsc = tsc_base;
+	tsc_per_tick = per_tick;
+	intr_set_level(old_level);
+
+	/* CPUID 0x80000007 EDX bit 8: invariant TSC */
+	cpuid(0x80000000, regs);
+	if (regs[0] >= 0x80000007)
+		cpuid(0x80000007, regs);
+	else
+		regs[3] = 0;
+	printf("TSC: %'" PRIu64 " kHz%s.\n", per_tick * TIMER_FREQ / 1000,
+		   regs[3] & (1 << 8) ? ", invariant" : "");
 }
 
 /* Returns the number of timer ticks since the OS booted. */
 int64_t
 timer_ticks(void)
 {
-	enum intr_level old_level = intr_disable();
-	int64_t t = ticks;
-	intr_set_level(old_level);
+	unsigned seq;
+	int64_t t;
+
+	do
+	{
+		seq = seq_read_begin(&ticks_seq);
+		t = ticks;
+	} while (seq_read_retry(&ticks_seq, seq));
 	barrier();
 	return t;
 }
@@ -98,6 +206,19 @@ timer_elapsed(int64_t then)
 	return timer_ticks() - then;
 }
 
+/* 부팅 후 지난 시간을 ns 단위로 반환한다. 단조 증가한다.
+   TSC 보정 전에는 틱 단위 해상도다. */
+int64_t
+timer_ns(void)
+{
+	uint64_t per_tick = tsc_per_tick;
+
+	barrier();
+	if (per_tick == 0)
+		return timer_ticks() * NS_PER_TICK;
+	return ns_base + (int64_t)(((unsigned __int128)(rdtsc() - tsc_base) * tsc_ns_mult) >> 32);
+}
+
 /* Suspends execution for approximately TICKS timer ticks. */
 // void timer_sleep(int64_t ticks)
 // {
@@ -108,22 +229,291 @@ timer_elapsed(int64_t then)
 // 		thread_yield();
 // }
 
-static bool wakeup_tick_less(const struct list_elem *a,
-							 const struct list_elem *b, void *aux UNUSED)
+/* Initializes timer event EV to call FUNC when it fires. */
+void timer_event_init(struct timer_event *ev, void (*func)(struct timer_event *))
 {
-	const struct thread *t1 = list_entry(a, struct thread, sleep_elem);
-	const struct thread *t2 = list_entry(b, struct thread, sleep_elem);
+	ev->func = func;
+	ev->pending = false;
+}
 
-	return t1->wakeup_tick < t2->wakeup_tick;
+/* EV가 EXPIRES 틱에 실행되도록 타이밍 휠에 넣는다. O(1).
+   이미 지난 시각이면 다음 틱에 실행된다. */
+void timer_event_add(struct timer_event *ev, int64_t expires)
+{
+	enum intr_level old_level = intr_disable();
+
+	ASSERT(!ev->pending);
+	ev->expires = expires;
+	ev->pending = true;
+	wheel_insert(ev, wheel_tick + 1);
+
+	intr_set_level(old_level);
+}
+
+/* 아직 실행되지 않은 EV를 취소한다. O(1).
+   취소했으면 true, 이미 실행됐거나 등록되지 않았으면 false. */
+bool timer_event_cancel(struct timer_event *ev)
+{
+	enum intr_level old_level = intr_disable();
+	bool pending = ev->pending;
+
+	if (pending)
+	{
+		list_remove(&ev->elem);
+		ev->pending = false;
+	}
+
+	intr_set_level(old_level);
+	return pending;
+}
+
+/* 남은 시간(expires - wheel_tick)에 맞는 레벨의 슬롯에 EV를 넣는다.
+   FIRST는 아직 슬롯이 처리되지 않은 가장 이른 틱이다: 평소에는
+   wheel_tick + 1이고, wheel_advance()가 cascade하는 동안에는 곧 처리될
+   wheel_tick 자신이다. 인터럽트가 꺼져 있어야 한다. */
+static void
+wheel_insert(struct timer_event *ev, int64_t first)
+{
+	int64_t expires = ev->expires;
+	int64_t delta;
+	int level;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	/* 이미 지난 이벤트는 FIRST 틱 슬롯으로, 너무 먼 이벤트는 최상위 레벨 끝으로 */
+	if (expires < first)
+		expires = first;
+	else if (expires - wheel_tick >= WHEEL_SPAN)
+		expires = wheel_tick + WHEEL_SPAN - 1;
+	delta = expires - wheel_tick;
+
+	for (level = 0; level < WHEEL_LEVELS - 1; level++)
+		if (delta < ((int64_t)1 << (WHEEL_BITS * (level + 1))))
+			break;
+
+	list_push_back(&wheel[level][(expires >> (WHEEL_BITS * level)) & WHEEL_MASK],
+				   &ev->elem);
+}
+
+/* 상위 레벨 LEVEL의 SLOT에 있던 이벤트들을 하위 레벨로 재배치한다. */
+static void
+wheel_cascade(int level, int slot)
+{
+	struct list moving;
+
+	list_init(&moving);
+	while (!list_empty(&wheel[level][slot]))
+		list_push_back(&moving, list_pop_front(&wheel[level][slot]));
+	while (!list_empty(&moving))
+		wheel_insert(list_entry(list_pop_front(&moving), struct timer_event, elem),
+					 wheel_tick);
+}
+
+/* 휠을 NOW 틱으로 한 칸 전진시키고, NOW에 만료된 이벤트를 실행한다.
+   틱당 상수 시간(상위 레벨 cascade는 64틱에 한 번)이 든다. */
+static void
+wheel_advance(int64_t now)
+{
+	struct list *slot;
+
+	wheel_tick = now;
+	for (int level = 1; level < WHEEL_LEVELS; level++)
+	{
+		if ((now & (((int64_t)1 << (WHEEL_BITS * level)) - 1)) != 0)
+			break;
+		wheel_cascade(level, (now >> (WHEEL_BITS * level)) & WHEEL_MASK);
+	}
+
+	slot = &wheel[0][now & WHEEL_MASK];
+	while (!list_empty(slot))
+	{
+		struct timer_event *ev = list_entry(list_pop_front(slot),
+											struct timer_event, elem);
+		ev->pending = false;
+		ev->func(ev);
+	}
+}
+
+/* 휠에서 다음 이벤트까지 아무 일도 없는 틱 수(최대 MAX)를 센다.
+   상위 레벨 cascade가 필요한 틱(64의 배수)에서는 멈춘다.
+   반환값 n은 wheel_tick + n 틱에 처음으로 할 일이 있다는 뜻이다. */
+static int
+wheel_idle_ticks(int max)
+{
+	int n;
+
+	for (n = 1; n < max; n++)
+	{
+		int64_t t = wheel_tick + n;
+		if ((t & WHEEL_MASK) == 0 || !list_empty(&wheel[0][t & WHEEL_MASK]))
+			break;
+	}
+	return n;
+}
+
+/* Programs counter 0 of the 8254 PIT to interrupt TIMER_FREQ
+   times per second. */
+static void
+pit_periodic(void)
+{
+	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
+	outb(0x40, PIT_COUNT & 0xff);
+	outb(0x40, PIT_COUNT >> 8);
+}
+
+/* Programs counter 0 of the 8254 PIT to interrupt once, COUNT
+   input clocks from now. */
+static void
+pit_oneshot(uint16_t count)
+{
+	outb(0x43, 0x30); /* CW: counter 0, LSB then MSB, mode 0, binary. */
+	outb(0x40, count & 0xff);
+	outb(0x40, count >> 8);
+}
+
+/* 주기 모드에서 one-shot 모드로 바꾼다. 다음 틱 경계는 마지막 틱
+   인터럽트로부터 한 틱 뒤로 잡는다. 인터럽트가 꺼져 있어야 한다. */
+static void
+clock_oneshot_start(void)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(tsc_per_tick != 0);
+
+	if (pit_oneshot_mode)
+		return;
+	pit_oneshot_mode = true;
+	next_tick_tsc = last_tick_tsc + tsc_per_tick;
+}
+
+/* one-shot 모드에서 다음 할 일의 시각에 맞춰 PIT를 건다.
+   기본은 다음 틱 경계이고, idle이 tickless로 대기 중이면 휠에 할 일이
+   있는 틱까지 미룬다. 그보다 이른 고해상도 sleep 마감이 있으면 그 시각.
+   PIT 카운터는 16비트라 한 번에 최대 약 55ms까지만 걸 수 있고, 그보다
+   멀면 중간에 한 번 깨어나 다시 건다. */
+static void
+clock_program(uint64_t now)
+{
+	uint64_t target = next_tick_tsc;
+	uint64_t delta;
+	uint16_t count;
+
+	ASSERT(pit_oneshot_mode);
+
+	if (idle_tickless)
+		target += (wheel_idle_ticks(WHEEL_SIZE) - 1) * tsc_per_tick;
+	if (!list_empty(&hr_sleepers))
+	{
+		struct timer_event *ev = list_entry(list_front(&hr_sleepers),
+											struct timer_event, elem);
+		if ((uint64_t)ev->expires < target)
+			target = ev->expires;
+	}
+
+	delta = target > now ? target - now : 0;
+	if (delta >= tsc_per_tick * 0xffff / PIT_COUNT)
+		count = 0xffff;
+	else
+		count = delta * PIT_COUNT / tsc_per_tick;
+	pit_oneshot(count > 0 ? count : 1);
+}
+
+/* NOW까지 만료된 고해상도 sleep을 깨운다. */
+static void
+hr_expire(uint64_t now)
+{
+	while (!list_empty(&hr_sleepers))
+	{
+		struct timer_event *ev = list_entry(list_front(&hr_sleepers),
+											struct timer_event, elem);
+		if ((uint64_t)ev->expires > now + tsc_slop)
+			break;
+		list_pop_front(&hr_sleepers);
+		ev->pending = false;
+		sleep_expired(ev);
+	}
+}
+
+/* one-shot 모드의 타이머 인터럽트 처리.
+   지나간 틱 경계마다 한 틱 분량의 일을 하고, 만료된 고해상도 sleep을
+   깨운 뒤 PIT를 다시 건다. 틱 경계에서 더 이상 one-shot이 필요 없으면
+   그 위상 그대로 주기 모드로 돌아간다. USER는 끊긴 쪽이 유저 모드인지. */
+static void
+clock_event(uint64_t now, bool user)
+{
+	bool ticked = false;
+
+	in_clock_event = true;
+	while (now + tsc_slop >= next_tick_tsc)
+	{
+		timer_do_tick(user);
+		next_tick_tsc += tsc_per_tick;
+		ticked = true;
+	}
+	hr_expire(now);
+	in_clock_event = false;
+
+	if (ticked && !idle_tickless && list_empty(&hr_sleepers))
+	{
+		pit_oneshot_mode = false;
+		last_tick_tsc = now;
+		pit_periodic();
+	}
+	else
+		clock_program(rdtsc());
+}
+
+/* idle 스레드가 hlt 직전에 호출한다(인터럽트 꺼진 상태).
+   -tickless이면 다음 타이머 이벤트까지 PIT를 one-shot으로 설정해
+   그 사이의 빈 틱 인터럽트를 건너뛴다. */
+void timer_idle_enter(void)
+{
+	uint64_t now;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+	if (!timer_tickless || tsc_per_tick == 0)
+		return;
+
+	now = rdtsc();
+	idle_tickless = true;
+	clock_oneshot_start();
+	clock_program(now);
+}
+
+/* idle 외의 스레드가 실행 가능해졌을 때 thread_unblock()이 호출한다.
+   tickless 대기 중이었다면 지금까지 지난 틱을 따라잡고 다음 틱
+   경계에 맞춰 PIT를 다시 건다. 틱 위상은 TSC 기준으로 유지된다. */
+void timer_idle_exit(void)
+{
+	if (!idle_tickless)
+		return;
+	ASSERT(intr_context());
+
+	idle_tickless = false;
+	if (!in_clock_event)
+		clock_event(rdtsc(), false);
+}
+
+/* timer_sleep()의 깨우기 이벤트: 잠든 스레드를 깨우고 선점을 검사한다. */
+static void
+sleep_expired(struct timer_event *ev)
+{
+	struct thread *t = (struct thread *)((uint8_t *)ev - offsetof(struct thread, sleep_event));
+
+	thread_unblock(t);
+
+	/* 선점 추가
+		priority scheduler일 때만 선점 검사
+	*/
+	if (!thread_mlfqs)
+		thread_preempt();
 }
 
 /*  busy wait 제거
 	ticks : 몇 틱이나 잘건지
 	intr_disable() : 원자적 처리를 위해 인터럽트 끄기
 	timer_ticks() : 현재 몇 틱인지
-	thread_current() : 현재 스레드 가져오기
 	start + ticks : 깨어날 시각
-	list_insert_ordered() : sleep_list에 정렬되게 추가해줌
+	timer_event_add() : 타이밍 휠에 O(1)로 깨우기 이벤트 등록
 	thread_block() : 블락 상태로 전환 후 schedule() 호출 후 cpu 양보
 	intr_set_level(old_level) : 이전 인터럽트 상태로 복원
 */
@@ -133,9 +523,40 @@ void timer_sleep(int64_t ticks)
 
 	int64_t start = timer_ticks();
 	enum intr_level old_level = intr_disable();
+	struct thread *curr = thread_current();
 
-	thread_current()->wakeup_tick = start + ticks;
-	list_insert_ordered(&sleep_list, &thread_current()->sleep_elem, wakeup_tick_less, NULL);
+	timer_event_init(&curr->sleep_event, sleep_expired);
+	timer_event_add(&curr->sleep_event, start + ticks);
+	thread_block();
+
+	intr_set_level(old_level);
+}
+
+/* hr_sleepers 정렬 기준: 마감 시각이 이른 순 */
+static bool
+hr_less(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
+{
+	return list_entry(a, struct timer_event, elem)->expires < list_entry(b, struct timer_event, elem)->expires;
+}
+
+/* 한 틱보다 짧은 CYCLES 동안 스레드를 재운다. PIT를 one-shot으로
+   마감 시각에 맞춰 걸고 블락하므로 CPU를 태우지 않는다. */
+static void
+hr_sleep(uint64_t cycles)
+{
+	ASSERT(intr_get_level() == INTR_ON);
+
+	enum intr_level old_level = intr_disable();
+	struct thread *curr = thread_current();
+	uint64_t now = rdtsc();
+
+	timer_event_init(&curr->sleep_event, sleep_expired);
+	curr->sleep_event.expires = now + cycles;
+	curr->sleep_event.pending = true;
+	list_insert_ordered(&hr_sleepers, &curr->sleep_event.elem, hr_less, NULL);
+
+	clock_oneshot_start();
+	clock_program(now);
 	thread_block();
 
 	intr_set_level(old_level);
@@ -169,16 +590,36 @@ void timer_print_stats(void)
 	tick++ : 시스템 전역 틱 카운트 증가
 	thread_tick() : 스레드 레벨에서 한틱 지남을 알림 -> time_slice 갱신
 	----
-	슬립 리스트에서 기상 시각 도달 스레드만 깨우기
-	sleep_list가 빈 리스트가 아니면 while 진입
-	t 에 sleep_list 가 있는 스레드 구조체 반환
-	앞에부터 순차 검사해서 현재 틱보다 작으면 다 언블락
+	wheel_advance() : 타이밍 휠을 한 칸 돌려 이번 틱에 만료된
+					  이벤트(잠든 스레드 깨우기 등)만 실행
 */
 static void
-timer_interrupt(struct intr_frame *args UNUSED)
+timer_interrupt(struct intr_frame *args)
+{
+	/* 유저 모드를 끊고 들어왔는지 (스레드별 utime/stime 구분용) */
+	bool user = args->cs == SEL_UCSEG;
+
+	/* one-shot 모드면 지난 틱과 고해상도 sleep을 처리하고 PIT를 다시 건다 */
+	if (pit_oneshot_mode)
+	{
+		clock_event(rdtsc(), user);
+		return;
+	}
+
+	if (tsc_per_tick != 0)
+		last_tick_tsc = rdtsc();
+	timer_do_tick(user);
+}
+
+/* 한 틱 분량의 일: 틱 카운트, 스레드 통계와 time slice, MLFQS 재계산,
+   타이밍 휠 처리. tickless 대기 후에는 건너뛴 틱마다 한 번씩 호출된다. */
+static void
+timer_do_tick(bool user)
 {
+	seq_write_begin(&ticks_seq);
 	ticks++;
-	thread_tick();
+	seq_write_end(&ticks_seq);
+	thread_tick(user);
 
 	/*mlfqs opt 시 관련 계산*/
 	if (thread_mlfqs)
@@ -196,22 +637,8 @@ timer_interrupt(struct intr_frame *args UNUSED)
 		}
 	}
 
-	/*슬립 리스트 처리*/
-	while (!list_empty(&sleep_list))
-	{
-		struct thread *t = list_entry(list_front(&sleep_list),
-									  struct thread, sleep_elem);
-		if (t->wakeup_tick > timer_ticks())
-			break;
-		list_pop_front(&sleep_list);
-		thread_unblock(t);
-
-		/* 선점 추가
-			priority scheduler일 때만 선점 검사
-		*/
-		if (!thread_mlfqs)
-			thread_preempt();
-	}
+	/* 타이밍 휠 처리 */
+	wheel_advance(ticks);
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -273,6 +700,22 @@ real_time_sleep(int64_t num, int32_t denom)
 		   sub-tick timing.  We scale the numerator and denominator
 		   down by 1000 to avoid the possibility of overflow. */
 		ASSERT(denom % 1000 == 0);
+
+		/* TSC가 보정되어 있으면 one-shot 타이머로 블락한다.
+		   tsc_slop보다 짧으면 깨우는 비용이 더 크므로 TSC로 돈다. */
+		if (tsc_per_tick != 0)
+		{
+			uint64_t cycles = tsc_per_tick * num / 1000 * TIMER_FREQ / (denom / 1000);
+			uint64_t start = rdtsc();
+
+			if (cycles > tsc_slop)
+				hr_sleep(cycles);
+			else
+				while (rdtsc() - start < cycles)
+					barrier();
+			return;
+		}
+
 		busy_wait(loops_per_tick * num / 1000 * TIMER_FREQ / (denom / 1000));
 	}
 }
@@ -1,7 +1,7 @@
 #include "filesys/file.h"
 #include <debug.h>
 #include "filesys/inode.h"
-#include "threads/malloc.h"
+#include "threads/slab.h"
 
 #include "threads/synch.h" /* 락을 위한 include*/
 #include "filesys/filesys.h"
@@ -14,6 +14,17 @@ struct file
 	int ref_cnt;		 /* fd 참조 개수 */
 };
 
+/* 열린 파일 구조체 전용 캐시 */
+static struct kmem_cache *file_slab;
+
+/* 파일 계층을 초기화한다. filesys_init()에서 호출된다. */
+void file_init(void)
+{
+	file_slab = kmem_cache_create("file", sizeof(struct file), NULL);
+	if (file_slab == NULL)
+		PANIC("cannot create file cache");
+}
+
 /* 콘솔을 가리키는 가짜 file 구조체 두 개 */
 struct file console_in;
 struct file console_out;
@@ -39,7 +50,7 @@ struct file *
 file_open(struct inode *inode)
 {
 	lock_acquire(&filesys_lock);
-	struct file *file = calloc(1, sizeof *file);
+	struct file *file = kmem_cache_zalloc(file_slab);
 	if (inode != NULL && file != NULL)
 	{
 		file->inode = inode;
@@ -50,7 +61,7 @@ file_open(struct inode *inode)
 	else
 	{
 		inode_close(inode);
-		free(file);
+		kmem_cache_free(file_slab, file);
 		file = NULL;
 	}
 	lock_release(&filesys_lock);
@@ -110,7 +121,7 @@ void file_close(struct file *file)
 	{
 		file_allow_write(file);
 		inode_close(file->inode);
-		free(file);
+		kmem_cache_free(file_slab, file);
 	}
 
 	lock_release(&filesys_lock);
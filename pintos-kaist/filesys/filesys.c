@@ -29,6 +29,7 @@ void filesys_init(bool format)
 		PANIC("hd0:1 (hdb) not present, file system initialization failed");
 
 	inode_init();
+	file_init();
 
 #ifdef EFILESYS
 	fat_init();
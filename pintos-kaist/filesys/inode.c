@@ -63,10 +63,39 @@ byte_to_sector(const struct inode *inode, off_t pos)
  * returns the same `struct inode'. */
 static struct list open_inodes;
 
+/* open_inodes 보호용 rwlock. 이미 열린 inode를 찾는 경로는 읽기로,
+   리스트에 넣고 빼는 경우만 쓰기로 잡는다.
+   다만 지금은 inode_open()/inode_close()를 부르는 곳이 모두 filesys_lock을
+   잡고 있어서 reader끼리 실제로 겹치는 일은 없다. 이 잠금은 open_inodes가
+   filesys_lock에 기대지 않게 해 둘 뿐이고, 읽기 경로가 정말 동시에 돌려면
+   filesys_lock부터 좁혀야 한다.
+   순서: filesys_lock -> open_inodes_lock -> inode_lock */
+static struct rwlock open_inodes_lock;
+
+static struct inode *open_inodes_find(disk_sector_t sector);
+
 /* Initializes the inode module. */
 void inode_init(void)
 {
 	list_init(&open_inodes);
+	rw_init(&open_inodes_lock);
+}
+
+/* open_inodes에서 SECTOR의 inode를 찾아 다시 연다. 없으면 NULL.
+   open_inodes_lock을 (읽기든 쓰기든) 잡고 불러야 한다. */
+static struct inode *
+open_inodes_find(disk_sector_t sector)
+{
+	struct list_elem *e;
+
+	for (e = list_begin(&open_inodes); e != list_end(&open_inodes);
+		 e = list_next(e))
+	{
+		struct inode *inode = list_entry(e, struct inode, elem);
+		if (inode->sector == sector)
+			return inode_reopen(inode);
+	}
+	return NULL;
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -115,20 +144,14 @@ bool inode_create(disk_sector_t sector, off_t length)
 struct inode *
 inode_open(disk_sector_t sector)
 {
-	struct list_elem *e;
-	struct inode *inode;
+	struct inode *inode, *found;
 
 	/* Check whether this inode is already open. */
-	for (e = list_begin(&open_inodes); e != list_end(&open_inodes);
-		 e = list_next(e))
-	{
-		inode = list_entry(e, struct inode, elem);
-		if (inode->sector == sector)
-		{
-			inode_reopen(inode);
-			return inode;
-		}
-	}
+	rw_read_acquire(&open_inodes_lock);
+	found = open_inodes_find(sector);
+	rw_read_release(&open_inodes_lock);
+	if (found != NULL)
+		return found;
 
 	/* Allocate memory. */
 	inode = malloc(sizeof *inode);
@@ -138,13 +161,26 @@ inode_open(disk_sector_t sector)
 	/* inode가 새로 생성되었으니 락도 초기화 */
 	lock_init(&inode->inode_lock);
 
-	/* Initialize. */
-	list_push_front(&open_inodes, &inode->elem);
+	/* Initialize. 디스크 읽기는 쓰기 잠금 밖에서 */
 	inode->sector = sector;
 	inode->open_cnt = 1;
 	inode->deny_write_cnt = 0;
 	inode->removed = false;
 	disk_read(filesys_disk, inode->sector, &inode->data);
+
+	/* 잠금을 푼 사이 다른 스레드가 먼저 열었을 수 있으니
+	   쓰기 잠금 아래에서 한 번 더 찾는다. */
+	rw_write_acquire(&open_inodes_lock);
+	found = open_inodes_find(sector);
+	if (found == NULL)
+		list_push_front(&open_inodes, &inode->elem);
+	rw_write_release(&open_inodes_lock);
+
+	if (found != NULL)
+	{
+		free(inode);
+		return found;
+	}
 	return inode;
 }
 
@@ -178,11 +214,27 @@ void inode_close(struct inode *inode)
 
 	lock_acquire(&inode->inode_lock);
 
+	/* 마지막 참조가 아니면 open_cnt만 줄이고 종료 */
+	if (inode->open_cnt > 1)
+	{
+		inode->open_cnt--;
+		lock_release(&inode->inode_lock);
+		return;
+	}
+	lock_release(&inode->inode_lock);
+
+	/* 마지막 참조일 수 있다. 0이 되는 것과 리스트에서 빠지는 것을
+	   쓰기 잠금 아래에서 함께 해야 open_inodes_find()가 닫히는
+	   중인 inode를 다시 열지 못한다. */
+	rw_write_acquire(&open_inodes_lock);
+	lock_acquire(&inode->inode_lock);
+
 	/* open_cnt 감소 후, 아직 더 열려 있으면 락만 풀고 종료 */
 	inode->open_cnt--;
 	if (inode->open_cnt > 0)
 	{
 		lock_release(&inode->inode_lock);
+		rw_write_release(&open_inodes_lock);
 		return;
 	}
 
@@ -198,6 +250,7 @@ void inode_close(struct inode *inode)
 
 	/* 락 해제 */
 	lock_release(&inode->inode_lock);
+	rw_write_release(&open_inodes_lock);
 
 	/* 블록 해제 */
 	if (do_remove)
@@ -1,7 +1,9 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <list.h>
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
@@ -12,6 +14,7 @@ void timer_calibrate (void);
 
 int64_t timer_ticks (void);
 int64_t timer_elapsed (int64_t);
+int64_t timer_ns (void);
 
 void timer_sleep (int64_t ticks);
 void timer_msleep (int64_t milliseconds);
@@ -20,4 +23,23 @@ void timer_nsleep (int64_t nanoseconds);
 
 void timer_print_stats (void);
 
+/* -tickless: Skip timer interrupts while the CPU is idle. */
+extern bool timer_tickless;
+void timer_idle_enter (void);
+void timer_idle_exit (void);
+
+/* A callback that runs in the timer interrupt once the tick
+   count reaches EXPIRES.  Pending events live in a hierarchical
+   timing wheel, so adding and cancelling are O(1). */
+struct timer_event {
+	int64_t expires;                /* Tick at which to fire. */
+	void (*func) (struct timer_event *);  /* Runs with interrupts off. */
+	struct list_elem elem;          /* Timing wheel slot element. */
+	bool pending;                   /* Added and not yet fired/cancelled. */
+};
+
+void timer_event_init (struct timer_event *, void (*func) (struct timer_event *));
+void timer_event_add (struct timer_event *, int64_t expires);
+bool timer_event_cancel (struct timer_event *);
+
 #endif /* devices/timer.h */
@@ -29,6 +29,7 @@ off_t file_length(struct file *);
 
 /* dup2 파일 입출력을 위한 선언 추가*/
 void console_file_init(void);
+void file_init(void);
 extern struct file console_in;
 extern struct file console_out;
 struct file *file_dup2(struct file *file);
@@ -0,0 +1,68 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Priority queue.
+ *
+ * This is a pairing heap.  Like the list and hash table, it does
+ * not allocate: each structure that can be in a heap embeds a
+ * struct heap_elem, and heap_entry() converts an element back to
+ * its structure.
+ *
+ * The element at the top is one that no other element is "less"
+ * than, according to the heap's heap_less_func.  To pop the
+ * highest priority first, write a comparison that returns true
+ * if A has higher priority than B.
+ *
+ * Costs, for a heap of N elements:
+ *   heap_push, heap_top, heap_raise   O(1)
+ *   heap_pop, heap_remove              O(log N) amortized
+ *   heap_update                        O(log N) amortized
+ *
+ * If an element's key changes while it is in a heap, the heap
+ * must be told with heap_raise() (the element moved toward the
+ * top) or heap_update() (any other change). */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem {
+	struct heap_elem *child;    /* Leftmost child. */
+	struct heap_elem *next;     /* Right sibling. */
+	struct heap_elem *prev;     /* Left sibling, or parent if leftmost. */
+};
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+ * the structure that HEAP_ELEM is embedded inside. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)           \
+	((STRUCT *) ((uint8_t *) (HEAP_ELEM)            \
+		- offsetof (STRUCT, MEMBER)))
+
+/* Compares the value of two heap elements A and B, given
+ * auxiliary data AUX.  Returns true if A belongs above B. */
+typedef bool heap_less_func (const struct heap_elem *a,
+		const struct heap_elem *b,
+		void *aux);
+
+/* Heap. */
+struct heap {
+	struct heap_elem *root;     /* Top element, or NULL if empty. */
+	size_t size;                /* Number of elements. */
+	heap_less_func *less;       /* Comparison function. */
+	void *aux;                  /* Auxiliary data for `less'. */
+};
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+
+bool heap_empty (const struct heap *);
+size_t heap_size (const struct heap *);
+struct heap_elem *heap_top (const struct heap *);
+
+void heap_push (struct heap *, struct heap_elem *);
+struct heap_elem *heap_pop (struct heap *);
+void heap_remove (struct heap *, struct heap_elem *);
+void heap_raise (struct heap *, struct heap_elem *);
+void heap_update (struct heap *, struct heap_elem *);
+
+#endif /* lib/kernel/heap.h */
@@ -0,0 +1,17 @@
+#ifndef __LIB_MEMSTAT_H
+#define __LIB_MEMSTAT_H
+
+#include <stdint.h>
+
+/* Memory usage of one process, as reported by the memstat system
+   call.  Page counts are in units of 4 kB pages. */
+struct memstat {
+	uint64_t rss;               /* Pages resident in frames. */
+	uint64_t file_pages;        /* Resident pages backed by a file mapping. */
+	uint64_t swapped;           /* Anonymous pages held in swap slots. */
+	uint64_t cow_shared;        /* Resident pages shared copy-on-write. */
+	uint64_t minor_faults;      /* Page faults resolved without I/O. */
+	uint64_t major_faults;      /* Page faults that read swap or a file. */
+};
+
+#endif /* lib/memstat.h */
@@ -0,0 +1,20 @@
+#ifndef __LIB_RUSAGE_H
+#define __LIB_RUSAGE_H
+
+#include <stdint.h>
+
+/* Values for the WHO argument of the getrusage system call. */
+#define RUSAGE_SELF 0           /* The calling process. */
+#define RUSAGE_CHILDREN (-1)    /* Children that have exited. */
+
+/* CPU usage of one process, as reported by the getrusage system
+   call.  CPU times are in timer ticks, sampled at each tick. */
+struct rusage {
+	int64_t utime;              /* Ticks spent running in user mode. */
+	int64_t stime;              /* Ticks spent running in the kernel. */
+	int64_t wait_ns;            /* Nanoseconds spent ready but not running. */
+	int64_t nvcsw;              /* Switches away because the thread blocked. */
+	int64_t nivcsw;             /* Switches away while still runnable. */
+};
+
+#endif /* lib/rusage.h */
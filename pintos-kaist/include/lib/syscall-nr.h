@@ -36,6 +36,19 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Extra for Project 3 */
+	SYS_MEMSTAT,                /* Report the process's memory usage. */
+
+	/* Stride scheduler. */
+	SYS_SETTICKETS,             /* Set the process's CPU share. */
+
+	/* Real-time scheduling class. */
+	SYS_SETRT,                  /* Reserve a budget per period. */
+	SYS_RTMISSES,               /* Count missed deadlines. */
+
+	/* CPU accounting. */
+	SYS_GETRUSAGE,              /* Report CPU usage. */
 };
 
 #endif /* lib/syscall-nr.h */
@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <memstat.h>
+#include <rusage.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -41,6 +43,17 @@ int dup2(int oldfd, int newfd);
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap (void *addr);
+int memstat (struct memstat *ms);
+
+/* Stride scheduler. */
+int settickets (int tickets);
+
+/* Real-time scheduling class. */
+int setrt (int budget, int period);
+int rtmisses (void);
+
+/* CPU accounting. */
+int getrusage (int who, struct rusage *ru);
 
 /* Project 4 only. */
 bool chdir (const char *dir);
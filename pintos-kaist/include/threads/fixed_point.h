@@ -8,16 +8,50 @@
 #define INT_MAX ((1 << 31) - 1)
 #define INT_MIN (-(1 << 31))
 
-int int_to_fp(int n);
-int fp_to_int(int x);
-int fp_to_int_round(int x);
-int add_fp(int x, int y);
-int sub_fp(int x, int y);
-int add_mixed(int x, int n);
-int sub_mixed(int x, int n);
-int mult_fp(int x, int y);
-int mult_mixed(int x, int n);
-int div_fp(int x, int y);
-int div_mixed(int x, int n);
+/* 타이머 인터럽트 안에서 매 틱 불리므로 모두 인라인으로 둔다. */
+static inline int int_to_fp(int n)
+{
+	return n * F;
+}
+static inline int fp_to_int(int x)
+{
+	return x / F;
+}
+static inline int fp_to_int_round(int x)
+{
+	return x >= 0 ? (x + F / 2) / F : (x - F / 2) / F;
+}
+static inline int add_fp(int x, int y)
+{
+	return x + y;
+}
+static inline int sub_fp(int x, int y)
+{
+	return x - y;
+}
+static inline int add_mixed(int x, int n)
+{
+	return x + n * F;
+}
+static inline int sub_mixed(int x, int n)
+{
+	return x - n * F;
+}
+static inline int mult_fp(int x, int y)
+{
+	return (int64_t)x * y / F;
+}
+static inline int mult_mixed(int x, int n)
+{
+	return x * n;
+}
+static inline int div_fp(int x, int y)
+{
+	return (int64_t)x * F / y;
+}
+static inline int div_mixed(int x, int n)
+{
+	return x / n;
+}
 
 #endif /* FIXED_POINT_H */
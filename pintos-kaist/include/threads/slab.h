@@ -0,0 +1,33 @@
+#ifndef THREADS_SLAB_H
+#define THREADS_SLAB_H
+
+#include <stddef.h>
+
+/* Object caches.
+
+   A cache hands out objects of one exact size, carved from
+   pages that hold nothing else, so a structure of 72 bytes costs
+   72 bytes instead of the 128 that malloc() would round it up
+   to.  Each cache has its own lock, so hot object types do not
+   contend with each other or with malloc().
+
+   If a cache has a constructor, it runs once when an object is
+   first carved out of a page, not on every allocation: objects
+   must be handed back to kmem_cache_free() in their constructed
+   state. */
+
+struct kmem_cache;
+typedef void kmem_ctor_func (void *obj);
+
+/* Maximum number of caches. */
+#define KMEM_CACHE_MAX 16
+
+struct kmem_cache *kmem_cache_create (const char *name, size_t size,
+                                      kmem_ctor_func *ctor);
+void *kmem_cache_alloc (struct kmem_cache *) __attribute__ ((malloc));
+void *kmem_cache_zalloc (struct kmem_cache *) __attribute__ ((malloc));
+void kmem_cache_free (struct kmem_cache *, void *);
+
+void kmem_cache_print_stats (void);
+
+#endif /* threads/slab.h */
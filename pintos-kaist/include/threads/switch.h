@@ -0,0 +1,31 @@
+#ifndef THREADS_SWITCH_H
+#define THREADS_SWITCH_H
+
+#include <stdint.h>
+
+/* Kernel-to-kernel context switch.
+ *
+ * Pushes the callee-saved registers (rbx, rbp, r12-r15) on the
+ * current kernel stack, stores the stack pointer into *PREV_RSP,
+ * loads NEXT_RSP and pops the next thread's callee-saved
+ * registers.  The return address left on the stack by the call
+ * is the saved rip.  Everything else is caller-saved under the
+ * System V ABI, so the compiler has already spilled it. */
+void switch_to (uint64_t *prev_rsp, uint64_t next_rsp);
+
+/* Stack frame that switch_to() pops, lowest address first. */
+struct switch_frame {
+	uint64_t r15;
+	uint64_t r14;
+	uint64_t r13;
+	uint64_t r12;
+	uint64_t rbx;
+	uint64_t rbp;
+	void (*rip) (void);
+};
+
+/* First-run entry of a new kernel thread.  switch_to() returns
+ * here and calls rbx (r12, r13). */
+void switch_entry (void);
+
+#endif /* threads/switch.h */
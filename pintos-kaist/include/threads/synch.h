@@ -1,13 +1,15 @@
 #ifndef THREADS_SYNCH_H
 #define THREADS_SYNCH_H
 
+#include <heap.h>
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* A counting semaphore. */
 struct semaphore {
 	unsigned value;             /* Current value. */
-	struct list waiters;        /* List of waiting threads. */
+	struct heap waiters;        /* Waiting threads, highest priority on top. */
 };
 
 void sema_init (struct semaphore *, unsigned value);
@@ -20,9 +22,19 @@ void sema_self_test (void);
 struct lock {
 	struct thread *holder;      /* Thread holding lock (for debugging). */
 	struct semaphore semaphore; /* Binary semaphore controlling access. */
+	union {
+		const char *name;           /* Class name, as initialized. */
+		struct lock_class *class;   /* Its class, once -lockstat looked it up. */
+	} stat;
 };
 
-void lock_init (struct lock *);
+/* Every lock initialized by the same lock_init() expression in
+   the same file shares one lock class, e.g. all malloc
+   descriptor locks.  -lockstat keeps statistics per class.  A
+   lock only remembers its class name until -lockstat first needs
+   the class, so initialization costs nothing without it. */
+#define lock_init(LOCK) lock_init_named (LOCK, __FILE__ ":" #LOCK)
+void lock_init_named (struct lock *, const char *class_name);
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
@@ -30,7 +42,7 @@ bool lock_held_by_current_thread (const struct lock *);
 
 /* Condition variable. */
 struct condition {
-	struct list waiters;        /* List of waiting threads. */
+	struct heap waiters;        /* Waiters, highest priority on top. */
 };
 
 void cond_init (struct condition *);
@@ -38,6 +50,68 @@ void cond_wait (struct condition *, struct lock *);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Spinlock.  Protects short, non-sleeping critical sections,
+   including ones entered with interrupts already off, where a
+   struct lock cannot be used.  Pintos runs on a single CPU, so
+   holding it just means interrupts are off; LOCKED catches a
+   nested acquisition, which could never be granted. */
+struct spinlock {
+	int locked;                 /* 1 while held. */
+	int old_level;              /* Interrupt level before spin_lock(). */
+};
+
+void spin_lock_init (struct spinlock *);
+void spin_lock (struct spinlock *);
+void spin_unlock (struct spinlock *);
+
+/* Reader-writer lock.  Any number of readers or one writer.
+   Writers are preferred: once a writer is waiting, new readers
+   wait behind it, so a steady stream of readers cannot starve
+   it.  The writer holds WLOCK for the whole write section, so
+   readers and writers waiting for it donate their priority to
+   it like for a plain lock.  Readers already inside are not
+   tracked, so a writer waiting for them to drain donates
+   nothing to them: read sections must be short and must not
+   block on anything a lower-priority thread holds.  A reader
+   must not take the same lock for reading again while holding
+   it, or it may deadlock behind a waiting writer. */
+struct rwlock {
+	struct lock wlock;          /* Held by the writer, if any. */
+	struct spinlock guard;      /* Protects the counters below. */
+	int readers;                /* Readers holding the lock. */
+	int writers;                /* Writers holding or waiting. */
+	bool draining;              /* Writer waits for READERS to reach 0. */
+	struct semaphore drained;   /* Upped when the last reader leaves. */
+};
+
+#define rw_init(RW) rw_init_named (RW, __FILE__ ":" #RW)
+void rw_init_named (struct rwlock *, const char *class_name);
+void rw_read_acquire (struct rwlock *);
+void rw_read_release (struct rwlock *);
+void rw_write_acquire (struct rwlock *);
+void rw_write_release (struct rwlock *);
+
+/* Sequence lock, for a few words of data that are read very
+   often and written rarely.  Readers take no lock: they read a
+   snapshot between seq_read_begin() and seq_read_retry() and try
+   again if a writer ran meanwhile.  Writers exclude each other
+   and interrupts, so they must not sleep.  A reader must only
+   copy the data, never follow pointers in it. */
+struct seqlock {
+	volatile unsigned seq;      /* Odd while a write is in progress. */
+	struct spinlock lock;       /* Serializes writers. */
+};
+
+void seq_init (struct seqlock *);
+unsigned seq_read_begin (const struct seqlock *);
+bool seq_read_retry (const struct seqlock *, unsigned start);
+void seq_write_begin (struct seqlock *);
+void seq_write_end (struct seqlock *);
+
+/* -lockstat: Profile lock contention, printed at shutdown. */
+extern bool lockstat_enabled;
+void lockstat_print (void);
+
 /* Optimization barrier.
  *
  * The compiler will not reorder operations across an
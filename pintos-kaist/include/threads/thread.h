@@ -4,7 +4,9 @@
 #include <debug.h>
 #include <list.h>
 #include <stdint.h>
+#include <rusage.h>
 #include "threads/interrupt.h"
+#include "devices/timer.h"
 #ifdef VM
 #include "vm/vm.h"
 #endif
@@ -30,13 +32,31 @@ typedef int tid_t;
 #define PRI_DEFAULT 31 /* Default priority. */
 #define PRI_MAX 63	   /* Highest priority. */
 
+/* stride 스케줄러의 티켓 */
+#define TICKETS_DEFAULT 100
+#define TICKETS_MAX 10000
+
 /* mlfqs 를 위한 #define 추가*/
 #define NICE_DEFAULT 0
 #define RECENT_CPU_DEFAULT 0
 #define LOAD_AVG_DEFAULT 0
 
 /* fd를 위한 #define 추가*/
-#define MAX_FD 512
+#define MAX_FD 512	/* fd 테이블이 늘어날 수 있는 최대 칸 수 (64의 배수) */
+#define FD_INLINE 8 /* struct thread 안에 두는 fd 칸 수 */
+
+/* 스레드의 CPU 사용량 (getrusage)
+	틱과 횟수는 32비트면 충분하므로 struct thread 안에서는 작게 두고,
+	thread_get_rusage()가 사용자에게 줄 struct rusage로 넓힌다.
+*/
+struct cpu_usage
+{
+	uint32_t utime;	 /* 유저 모드에서 보낸 틱 */
+	uint32_t stime;	 /* 커널에서 보낸 틱 */
+	uint32_t nvcsw;	 /* 블록되어 CPU를 넘긴 횟수 */
+	uint32_t nivcsw; /* 실행 가능한 채로 CPU를 빼앗긴 횟수 */
+	int64_t wait_ns; /* ready 큐에서 기다린 시간 (ns) */
+};
 
 /* A kernel thread or user process.
  *
@@ -106,6 +126,17 @@ struct thread
 	/* Shared between thread.c and synch.c. */
 	struct list_elem elem; /* List element. */
 
+	/* 세마포어/condvar 대기 힙 (synch.c)
+		wait_elem : 세마포어 waiters 힙의 원소
+		wait_heap, wait_helem : 지금 우선순위 순으로 기다리고 있는 힙과
+			그 안의 원소. 기부로 우선순위가 바뀌면 여기서 자리를 고친다.
+		wait_seq : 같은 우선순위끼리 먼저 온 순서
+	*/
+	struct heap_elem wait_elem;
+	struct heap *wait_heap;
+	struct heap_elem *wait_helem;
+	uint64_t wait_seq;
+
 #ifdef USERPROG
 	/* Owned by userprog/process.c. */
 	uint64_t *pml4; /* Page map level 4 */
@@ -115,15 +146,15 @@ struct thread
 	struct supplemental_page_table spt;
 	void *stack_bottom; // 스택이 허용하는 최하단 주소
 	void *rsp_stack;	// 유저 모드에서 커널로 진입할 때마다 저장해 두는 RSP
+	struct memstat memstat; // 프로세스별 메모리 사용량 통계
 #endif
 
 	/* Owned by thread.c. */
-	struct intr_frame tf; /* Information for switching */
+	uint64_t rsp;		  /* Saved kernel stack pointer (switch_to). */
 	unsigned magic;		  /* Detects stack overflow. */
 
-	/* alarm을 위한 깨울 시각, 슬립 리스트 연결용 엘리먼트 추가*/
-	int64_t wakeup_tick;
-	struct list_elem sleep_elem;
+	/* alarm을 위한 깨우기 타이머 (timer_sleep) */
+	struct timer_event sleep_event;
 
 	/* donate를 위한 변수들
 		base_priority : 원래 우선순위
@@ -139,6 +170,43 @@ struct thread
 	/* mlfqs를 위한 변수 추가*/
 	int nice;
 	int recent_cpu;
+	unsigned mlfqs_epoch;		 /* recent_cpu에 적용된 감쇠 횟수 */
+	bool mlfqs_dirty;			 /* mlfqs_dirty_list에 있는지 */
+	struct list_elem mlfqs_elem; /* mlfqs_dirty_list의 리스트 요소 */
+
+	/* stride 스케줄러를 위한 변수 (-stride) */
+	int tickets;						/* CPU 몫의 비율 */
+	int64_t stride;						/* STRIDE1 / tickets */
+	int64_t pass;						/* 누적 가상 시간 */
+	struct thread *stride_left;			/* pass 순 leftist 힙의 자식 */
+	struct thread *stride_right;
+	int stride_rank;
+
+	/* 실시간(EDF) 클래스를 위한 변수 (thread_set_realtime) */
+	int rt_budget;				  /* 주기마다 보장받는 틱 수, 0이면 일반 클래스 */
+	int rt_period;				  /* 주기 (틱) */
+	int rt_util;				  /* 예약한 CPU 비율 (천분율) */
+	int rt_left;				  /* 이번 주기에 남은 예산 */
+	int64_t rt_deadline;		  /* 이번 주기의 마감 시각 (틱) */
+	bool rt_throttled;			  /* 예산을 다 써서 다음 주기까지 쉬는 중 */
+	struct timer_event rt_event;  /* 다음 주기에 예산을 채우는 타이머 */
+	int rt_misses;				  /* 놓친 마감 횟수 */
+
+	/* CPU 사용량 통계 (getrusage)
+		rusage : 이 스레드가 쓴 유저/커널 틱, ready 대기 시간, 문맥 교환 횟수
+		rusage_children : 종료한 자식들의 rusage 합계
+		ready_since : ready 큐에 들어간 시각 (ns)
+	*/
+	struct cpu_usage rusage;
+	struct cpu_usage rusage_children;
+	int64_t ready_since;
+
+	/* 스케줄링 지연 추적 (thread_print_stats)
+		run_since : 이번에 CPU를 받은 시각 (ns)
+		woken : thread_unblock으로 ready가 됐는지 (양보·선점과 구분)
+	*/
+	int64_t run_since;
+	bool woken;
 
 	/* all_list의 리스트 요소*/
 	struct list_elem allelem;
@@ -150,9 +218,18 @@ struct thread
 	struct list children; // struct child_status elem 들의 리스트
 	tid_t parent_tid;	  // 나의 부모를 기록
 
-	/* fd 테이블을 추가*/
-	struct file **fd_table; // fd_table 동적할당으로 변경
-	int next_fd;
+	/* fd 테이블을 추가
+		fd_table : 처음엔 fd_inline, 넘치면 두 배씩 malloc으로 늘린다
+		fd_used : 사용 중인 fd 비트맵 (가장 작은 빈 fd를 바로 찾는다).
+			처음엔 fd_used_inline 한 워드, 테이블을 늘리면 그 뒤에 붙여 할당한다
+		fd_end : 사용 중인 가장 큰 fd + 1, fork/exit는 여기까지만 본다
+	*/
+	struct file **fd_table;
+	uint64_t *fd_used;
+	int fd_cap;
+	int fd_end;
+	uint64_t fd_used_inline;
+	struct file *fd_inline[FD_INLINE];
 
 	/* rox를 위한 자신이 실행한 프로그램을 가짐 */
 	struct file *exec_prog;
@@ -173,10 +250,14 @@ struct child_status
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If true, use the stride (proportional-share) scheduler.
+   Controlled by kernel command-line option "-stride". */
+extern bool thread_stride;
+
 void thread_init(void);
 void thread_start(void);
 
-void thread_tick(void);
+void thread_tick(bool user);
 void thread_print_stats(void);
 
 typedef void thread_func(void *aux);
@@ -195,6 +276,18 @@ void thread_yield(void);
 int thread_get_priority(void);
 void thread_set_priority(int);
 
+struct file *thread_fd_get(struct thread *t, int fd);
+bool thread_fd_set(struct thread *t, int fd, struct file *f);
+int thread_fd_alloc(struct thread *t, struct file *f);
+
+bool thread_set_realtime(int budget, int period);
+int thread_get_rt_misses(void);
+
+bool thread_get_rusage(int who, struct rusage *ru);
+
+bool thread_set_tickets(int tickets);
+int thread_get_tickets(void);
+
 int thread_get_nice(void);
 void thread_set_nice(int);
 int thread_get_recent_cpu(void);
@@ -212,9 +305,6 @@ void thread_donate_priority(void);
 void thread_remove_donations_for_lock(struct lock *lock);
 void thread_update_priority(void);
 
-/* ready_list 비교함수 선언*/
-bool thread_priority_greater(const struct list_elem *a, const struct list_elem *b, void *aux);
-
 /* 양보 시 우선순위 선점 함수 선언*/
 void thread_preempt(void);
 
@@ -0,0 +1,59 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "devices/timer.h"
+
+/* 커널 worker 스레드가 나중에 실행하는 작업.
+
+   work는 workqueue에 들어갔다가 그 큐의 worker 스레드 중 하나에서
+   실행되므로, 함수 안에서 잠들거나 락을 잡거나 메모리를 할당해도 된다.
+   큐에 넣는 쪽은 잠들지 않아서 인터럽트 핸들러에서도 부를 수 있다.
+   그래서 work를 인터럽트의 bottom half로 쓸 수 있다: 핸들러는 장치에
+   응답만 하고 느린 부분은 큐에 넣는다. delayed work는 지연 시간이
+   지나면 타이머 인터럽트가 큐에 넣는다. */
+
+struct work;
+struct workqueue;
+typedef void work_func (struct work *);
+
+/* 나중에 실행할 작업 하나. 함수가 필요로 하는 구조체 안에 넣고,
+   list_entry()처럼 포인터 계산으로 그 구조체를 되찾는다. */
+struct work {
+	struct list_elem elem;          /* 큐의 대기 리스트 원소 */
+	work_func *func;                /* 실행할 함수 */
+	struct workqueue *wq;           /* 마지막으로 들어간 큐 */
+	bool pending;                   /* 큐에 들어 있고 아직 시작 전 */
+};
+
+/* 타이머 틱 단위의 지연 뒤에 큐에 들어가는 work */
+struct delayed_work {
+	struct work work;
+	struct timer_event timer;       /* 울리면 WORK를 큐에 넣는다 */
+};
+
+/* 큐 하나의 최대 worker 스레드 수 */
+#define WQ_MAX_WORKERS 8
+
+/* 특별한 요구가 없는 work를 위한 공용 큐.
+   worker 수는 "-kworkers=N" 커널 옵션으로 정한다. */
+extern struct workqueue *system_wq;
+extern int system_wq_workers;
+
+void workqueue_init (void);
+struct workqueue *workqueue_create (const char *name, int priority,
+                                    int workers);
+void workqueue_flush (struct workqueue *);
+
+void work_init (struct work *, work_func *);
+bool work_queue (struct workqueue *, struct work *);
+bool work_cancel (struct work *);
+
+void delayed_work_init (struct delayed_work *, work_func *);
+bool delayed_work_queue (struct workqueue *, struct delayed_work *,
+                         int64_t ticks);
+bool delayed_work_cancel (struct delayed_work *);
+
+#endif /* threads/workqueue.h */
@@ -9,6 +9,9 @@ int process_exec(void *f_name);
 int process_wait(tid_t);
 void process_exit(void);
 void process_activate(struct thread *next);
+void process_slab_init(void);
+
+extern bool rusage_at_exit;
 
 /* lazy load를 위한 구조체, 페이지 불러올 때 필요한 정보들 */
 struct load_info
@@ -3,6 +3,7 @@
 #include "vm/vm.h"
 struct page;
 enum vm_type;
+struct supplemental_page_table;
 
 /* 익명 페이지가 스왑 디스크의 어느 슬롯에 저장되었는지를 기록하는 용도*/
 struct anon_page
@@ -12,5 +13,6 @@ struct anon_page
 
 void vm_anon_init(void);
 bool anon_initializer(struct page *page, enum vm_type type, void *kva);
+void anon_swap_slots_release(struct supplemental_page_table *spt);
 
 #endif
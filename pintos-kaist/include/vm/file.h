@@ -5,6 +5,7 @@
 
 struct page;
 enum vm_type;
+struct supplemental_page_table;
 
 struct file_page
 {
@@ -23,4 +24,5 @@ bool file_backed_initializer(struct page *page, enum vm_type type, void *kva);
 void *do_mmap(void *addr, size_t length, int writable,
 			  struct file *file, off_t offset);
 void do_munmap(void *va);
+void file_backed_teardown(struct supplemental_page_table *spt, uint64_t *pml4);
 #endif
@@ -0,0 +1,47 @@
+#ifndef VM_STATS_H
+#define VM_STATS_H
+#include <stdint.h>
+
+/* 페이지 폴트 종류 */
+enum vm_fault_kind
+{
+	VM_FAULT_ELF,	  /* 실행 파일 세그먼트 lazy load */
+	VM_FAULT_ZERO,	  /* 0으로 채우는 익명 페이지 */
+	VM_FAULT_MMAP,	  /* mmap 파일 페이지 */
+	VM_FAULT_STACK,	  /* 스택 확장 */
+	VM_FAULT_SWAP_IN, /* 스왑 디스크에서 읽어오기 */
+	VM_FAULT_WP,	  /* 쓰기 보호 위반 */
+	VM_FAULT_CNT
+};
+
+/* log2 구간별 지연 시간 히스토그램 (단위: TSC cycle).
+   bucket[k]에는 [2^k, 2^(k+1)) cycle이 걸린 횟수가 쌓인다. */
+#define VM_HIST_BUCKETS 64
+struct vm_hist
+{
+	uint64_t cnt;
+	uint64_t sum;
+	uint64_t max;
+	uint64_t bucket[VM_HIST_BUCKETS];
+};
+
+/* VM 전역 이벤트 카운터. 통계용이라 락 없이 갱신한다
+   (swap_in_use/swap_peak는 swap_lock 아래에서 갱신). */
+struct vm_stats
+{
+	uint64_t faults[VM_FAULT_CNT];
+	uint64_t evict_anon;   /* 축출된 익명 페이지 */
+	uint64_t evict_file;   /* 축출된 파일 페이지 */
+	uint64_t writebacks;   /* 파일에 다시 쓴 dirty 페이지 */
+	uint64_t swap_in_use;  /* 사용 중인 스왑 슬롯 */
+	uint64_t swap_peak;	   /* swap_in_use 최댓값 */
+	struct vm_hist fault_lat; /* vm_try_handle_fault() 소요 시간 */
+	struct vm_hist evict_lat; /* vm_evict_frame() 소요 시간 */
+};
+
+extern struct vm_stats vm_stats;
+
+void vm_hist_add(struct vm_hist *hist, uint64_t cycles);
+void vm_print_stats(void);
+
+#endif /* vm/stats.h */
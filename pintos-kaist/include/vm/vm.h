@@ -1,6 +1,7 @@
 #ifndef VM_VM_H
 #define VM_VM_H
 #include <stdbool.h>
+#include <memstat.h>
 #include "threads/palloc.h"
 #include "hash.h"
 
@@ -71,6 +72,7 @@ struct frame
 	void *kva;					 // 커널 가상 주소 : 물리 메모리에 데이터가 저장되는 곳의 주소
 	struct page *page;			 // 이 프레임이 매핑되어 있는 사용자 가상 페이지
 	struct list_elem frame_elem; // frame_table을 위한 list_elem 추가
+	struct thread *owner;		 // 이 프레임을 쓰는 프로세스 (메모리 통계 집계용)
 };
 
 /* The function table for page operations.
@@ -97,6 +99,7 @@ struct page_operations
 struct supplemental_page_table
 {
 	struct hash spt_hash; // hash 형식으로 spt 관리
+	bool teardown;		  // 주소 공간 전체를 내리는 중이면 true (페이지 단위 unmap 생략)
 };
 
 #include "threads/thread.h"
@@ -108,6 +111,13 @@ struct page *spt_find_page(struct supplemental_page_table *spt, void *va);
 bool spt_insert_page(struct supplemental_page_table *spt, struct page *page);
 bool spt_remove_page(struct supplemental_page_table *spt, struct page *page);
 
+/* -memstat: 프로세스 종료 시 메모리 통계 출력 여부 */
+extern bool memstat_at_exit;
+
+/* mmap aux(struct file_page) 전용 객체 캐시 */
+struct kmem_cache;
+extern struct kmem_cache *file_page_slab;
+
 void vm_init(void);
 bool vm_try_handle_fault(struct intr_frame *f, void *addr, bool user,
 						 bool write, bool not_present);
@@ -117,7 +127,9 @@ bool vm_try_handle_fault(struct intr_frame *f, void *addr, bool user,
 bool vm_alloc_page_with_initializer(enum vm_type type, void *upage,
 									bool writable, vm_initializer *init, void *aux);
 void vm_dealloc_page(struct page *page);
+void vm_free_frame(struct page *page);
 bool vm_claim_page(void *va);
 enum vm_type page_get_type(struct page *page);
+void memstat_print(struct thread *t);
 
 #endif /* VM_VM_H */
@@ -0,0 +1,188 @@
+#include "heap.h"
+#include "../debug.h"
+
+/* Pairing heap.
+
+   The heap is a tree in which every element is "less" than or
+   equal to its children.  Children are kept in a doubly linked
+   list: a node's PREV points to its left sibling, or to its
+   parent if it is the leftmost child.  The root has no siblings.
+
+   Two trees are melded by making the root that loses the
+   comparison the leftmost child of the other, in O(1).  Popping
+   the root melds its children in two passes, left to right in
+   pairs and then right to left, which is what gives the
+   O(log N) amortized bound. */
+
+static struct heap_elem *meld (struct heap *, struct heap_elem *,
+                               struct heap_elem *);
+static struct heap_elem *merge_pairs (struct heap *, struct heap_elem *);
+static void cut (struct heap_elem *);
+
+/* Initializes HEAP as an empty heap ordered by LESS given
+   auxiliary data AUX. */
+void
+heap_init (struct heap *heap, heap_less_func *less, void *aux) {
+	ASSERT (heap != NULL);
+	ASSERT (less != NULL);
+
+	heap->root = NULL;
+	heap->size = 0;
+	heap->less = less;
+	heap->aux = aux;
+}
+
+/* Returns true if HEAP is empty, false otherwise. */
+bool
+heap_empty (const struct heap *heap) {
+	return heap->root == NULL;
+}
+
+/* Returns the number of elements in HEAP. */
+size_t
+heap_size (const struct heap *heap) {
+	return heap->size;
+}
+
+/* Returns the top element of HEAP without removing it.
+   HEAP must not be empty. */
+struct heap_elem *
+heap_top (const struct heap *heap) {
+	ASSERT (!heap_empty (heap));
+	return heap->root;
+}
+
+/* Inserts ELEM into HEAP. */
+void
+heap_push (struct heap *heap, struct heap_elem *elem) {
+	ASSERT (elem != NULL);
+
+	elem->child = elem->next = elem->prev = NULL;
+	heap->root = meld (heap, heap->root, elem);
+	heap->size++;
+}
+
+/* Removes and returns the top element of HEAP, which must not be
+   empty. */
+struct heap_elem *
+heap_pop (struct heap *heap) {
+	struct heap_elem *top;
+
+	ASSERT (!heap_empty (heap));
+
+	top = heap->root;
+	heap->root = merge_pairs (heap, top->child);
+	heap->size--;
+	top->child = NULL;
+	return top;
+}
+
+/* Removes ELEM, which must be in HEAP, from HEAP. */
+void
+heap_remove (struct heap *heap, struct heap_elem *elem) {
+	ASSERT (!heap_empty (heap));
+
+	if (elem == heap->root) {
+		heap_pop (heap);
+		return;
+	}
+	cut (elem);
+	heap->root = meld (heap, heap->root, merge_pairs (heap, elem->child));
+	heap->size--;
+	elem->child = NULL;
+}
+
+/* Restores HEAP's order after ELEM's key changed so that it
+   belongs no lower than before (a "decrease-key").  ELEM's
+   subtree is still ordered, so it is cut off and melded with the
+   root. */
+void
+heap_raise (struct heap *heap, struct heap_elem *elem) {
+	if (elem == heap->root)
+		return;
+	cut (elem);
+	heap->root = meld (heap, heap->root, elem);
+}
+
+/* Restores HEAP's order after any change to ELEM's key. */
+void
+heap_update (struct heap *heap, struct heap_elem *elem) {
+	heap_remove (heap, elem);
+	heap_push (heap, elem);
+}
+
+/* Melds the trees rooted at A and B, either of which may be
+   null, and returns the new root.  A and B must have no
+   siblings. */
+static struct heap_elem *
+meld (struct heap *heap, struct heap_elem *a, struct heap_elem *b) {
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+
+	/* Keep A on top unless B is less. */
+	if (heap->less (b, a, heap->aux)) {
+		struct heap_elem *t = a;
+		a = b;
+		b = t;
+	}
+
+	b->prev = a;
+	b->next = a->child;
+	if (a->child != NULL)
+		a->child->prev = b;
+	a->child = b;
+	a->prev = a->next = NULL;
+	return a;
+}
+
+/* Melds the list of sibling trees starting at FIRST into a
+   single tree and returns its root, or a null pointer if FIRST
+   is null. */
+static struct heap_elem *
+merge_pairs (struct heap *heap, struct heap_elem *first) {
+	struct heap_elem *stack = NULL;
+	struct heap_elem *root = NULL;
+
+	/* Left to right: meld adjacent pairs, pushing each result on
+	   a stack linked through NEXT. */
+	while (first != NULL) {
+		struct heap_elem *a = first;
+		struct heap_elem *b = a->next;
+		struct heap_elem *m;
+
+		first = b != NULL ? b->next : NULL;
+		a->prev = a->next = NULL;
+		if (b != NULL)
+			b->prev = b->next = NULL;
+		m = meld (heap, a, b);
+		m->next = stack;
+		stack = m;
+	}
+
+	/* Right to left: meld the pairs into one tree. */
+	while (stack != NULL) {
+		struct heap_elem *next = stack->next;
+
+		stack->next = NULL;
+		root = meld (heap, root, stack);
+		stack = next;
+	}
+	return root;
+}
+
+/* Detaches the subtree rooted at ELEM, which must not be a
+   heap's root, from its parent and siblings. */
+static void
+cut (struct heap_elem *elem) {
+	ASSERT (elem->prev != NULL);
+
+	if (elem->prev->child == elem)
+		elem->prev->child = elem->next;
+	else
+		elem->prev->next = elem->next;
+	if (elem->next != NULL)
+		elem->next->prev = elem->prev;
+	elem->prev = elem->next = NULL;
+}
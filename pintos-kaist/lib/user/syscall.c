@@ -155,6 +155,31 @@ munmap (void *addr) {
 	syscall1 (SYS_MUNMAP, addr);
 }
 
+int
+memstat (struct memstat *ms) {
+	return syscall1 (SYS_MEMSTAT, ms);
+}
+
+int
+settickets (int tickets) {
+	return syscall1 (SYS_SETTICKETS, tickets);
+}
+
+int
+setrt (int budget, int period) {
+	return syscall2 (SYS_SETRT, budget, period);
+}
+
+int
+rtmisses (void) {
+	return syscall0 (SYS_RTMISSES);
+}
+
+int
+getrusage (int who, struct rusage *ru) {
+	return syscall2 (SYS_GETRUSAGE, who, ru);
+}
+
 bool
 chdir (const char *dir) {
 	return syscall1 (SYS_CHDIR, dir);
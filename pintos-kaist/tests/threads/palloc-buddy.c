@@ -0,0 +1,136 @@
+/* Exercises the buddy page allocator.  Allocates runs of pages
+   of mixed sizes, many of them not a power of two, so that the
+   unused tail of each block must be given back, and frees them
+   in a scrambled order.  Then carves the whole user pool into
+   its largest blocks, which include the blocks at the pool's
+   end whose buddies would lie past it, and frees those too.
+   Each time, the pool must end up with as many free pages and as
+   large a free block as it started with. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Page counts for the mixed allocations. */
+static const size_t sizes[] = {1, 3, 5, 2, 7, 16, 1, 12, 9, 4, 31, 6};
+#define SIZE_CNT (sizeof sizes / sizeof *sizes)
+
+/* Order in which the mixed allocations are freed. */
+static const int free_order[SIZE_CNT] = {3, 0, 7, 11, 5, 1, 9, 2, 10, 6, 4, 8};
+
+/* Most blocks the user pool is expected to split into. */
+#define BLOCK_MAX 128
+
+static void fill (uint8_t *pages, size_t page_cnt, int id);
+static void check (uint8_t *pages, size_t page_cnt, int id);
+
+void
+test_palloc_buddy (void)
+{
+  static uint8_t *blocks[BLOCK_MAX];
+  static size_t block_pages[BLOCK_MAX];
+  size_t free0, largest0, free_pages, largest;
+  size_t i;
+  int block_cnt;
+
+  /* Mixed orders from the kernel pool. */
+  palloc_get_stats (0, &free0, &largest0);
+  for (i = 0; i < SIZE_CNT; i++)
+    {
+      size_t before;
+
+      palloc_get_stats (0, &before, &largest);
+      blocks[i] = palloc_get_multiple (0, sizes[i]);
+      if (blocks[i] == NULL)
+        fail ("allocating %zu pages failed", sizes[i]);
+      if (pg_ofs (blocks[i]) != 0)
+        fail ("%zu-page allocation is not page-aligned", sizes[i]);
+      palloc_get_stats (0, &free_pages, &largest);
+      if (before - free_pages != sizes[i])
+        fail ("allocating %zu pages took %zu from the pool",
+              sizes[i], before - free_pages);
+      fill (blocks[i], sizes[i], i);
+    }
+  msg ("allocated %d runs of mixed sizes", (int) SIZE_CNT);
+
+  for (i = 0; i < SIZE_CNT; i++)
+    check (blocks[i], sizes[i], i);
+  msg ("runs do not overlap");
+
+  for (i = 0; i < SIZE_CNT; i++)
+    {
+      int j = free_order[i];
+      palloc_free_multiple (blocks[j], sizes[j]);
+    }
+  palloc_get_stats (0, &free_pages, &largest);
+  if (free_pages != free0)
+    fail ("kernel pool has %zu free pages after freeing, not %zu",
+          free_pages, free0);
+  if (largest != largest0)
+    fail ("kernel pool's largest block is %zu pages after freeing, not %zu",
+          largest, largest0);
+  msg ("kernel pool restored");
+
+  /* Whole user pool, largest block first. */
+  palloc_get_stats (PAL_USER, &free0, &largest0);
+  if (free0 == 0)
+    fail ("user pool is empty");
+  block_cnt = 0;
+  for (;;)
+    {
+      palloc_get_stats (PAL_USER, &free_pages, &largest);
+      if (free_pages == 0)
+        break;
+      if (block_cnt == BLOCK_MAX)
+        fail ("user pool split into more than %d blocks", BLOCK_MAX);
+      blocks[block_cnt] = palloc_get_multiple (PAL_USER, largest);
+      if (blocks[block_cnt] == NULL)
+        fail ("allocating a free %zu-page block failed", largest);
+      block_pages[block_cnt] = largest;
+      fill (blocks[block_cnt], largest, block_cnt);
+      block_cnt++;
+    }
+  msg ("user pool used up");
+
+  for (i = 0; i < (size_t) block_cnt; i++)
+    check (blocks[i], block_pages[i], i);
+  while (block_cnt-- > 0)
+    palloc_free_multiple (blocks[block_cnt], block_pages[block_cnt]);
+  palloc_get_stats (PAL_USER, &free_pages, &largest);
+  if (free_pages != free0)
+    fail ("user pool has %zu free pages after freeing, not %zu",
+          free_pages, free0);
+  if (largest != largest0)
+    fail ("user pool's largest block is %zu pages after freeing, not %zu",
+          largest, largest0);
+  msg ("user pool restored");
+}
+
+/* Marks each of the PAGE_CNT pages at PAGES with ID. */
+static void
+fill (uint8_t *pages, size_t page_cnt, int id)
+{
+  size_t i;
+
+  for (i = 0; i < page_cnt; i++)
+    {
+      pages[i * PGSIZE] = id;
+      pages[i * PGSIZE + PGSIZE - 1] = id;
+    }
+}
+
+/* Checks that each of the PAGE_CNT pages at PAGES is still
+   marked with ID. */
+static void
+check (uint8_t *pages, size_t page_cnt, int id)
+{
+  size_t i;
+
+  for (i = 0; i < page_cnt; i++)
+    if (pages[i * PGSIZE] != (uint8_t) id
+        || pages[i * PGSIZE + PGSIZE - 1] != (uint8_t) id)
+      fail ("page %zu of run %d was overwritten", i, id);
+}
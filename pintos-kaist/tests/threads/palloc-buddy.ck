@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(palloc-buddy) begin
+(palloc-buddy) allocated 12 runs of mixed sizes
+(palloc-buddy) runs do not overlap
+(palloc-buddy) kernel pool restored
+(palloc-buddy) user pool used up
+(palloc-buddy) user pool restored
+(palloc-buddy) end
+EOF
+pass;
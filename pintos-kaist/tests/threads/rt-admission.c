@@ -0,0 +1,57 @@
+/* Checks admission control for the real-time class: a
+   reservation that would push the reserved share of all
+   real-time threads over 90% of the CPU is rejected and leaves
+   the caller's old reservation in place.  A full reservation
+   large enough to overflow BUDGET * 1000 in an int must still be
+   rejected. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func second_thread;
+static struct semaphore done_sema;
+
+static const char *
+verdict (bool accepted) 
+{
+  return accepted ? "accepted" : "rejected";
+}
+
+void
+test_rt_admission (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done_sema, 0);
+
+  msg ("main reserves 5 of 10 ticks: %s", verdict (thread_set_realtime (5, 10)));
+
+  thread_create ("second", PRI_DEFAULT, second_thread, NULL);
+  sema_down (&done_sema);
+
+  msg ("main asks for 10 of 10 ticks: %s",
+       verdict (thread_set_realtime (10, 10)));
+  msg ("main asks for 9 of 10 ticks: %s", verdict (thread_set_realtime (9, 10)));
+  msg ("main asks for 3 of 2 ticks: %s", verdict (thread_set_realtime (3, 2)));
+  msg ("main asks for 1 of 0 ticks: %s", verdict (thread_set_realtime (1, 0)));
+  msg ("main asks for 3000000 of 3000000 ticks: %s",
+       verdict (thread_set_realtime (3000000, 3000000)));
+  msg ("main leaves the real-time class: %s",
+       verdict (thread_set_realtime (0, 0)));
+}
+
+static void
+second_thread (void *aux UNUSED) 
+{
+  msg ("second reserves 5 of 10 ticks: %s",
+       verdict (thread_set_realtime (5, 10)));
+  msg ("second reserves 4 of 10 ticks: %s",
+       verdict (thread_set_realtime (4, 10)));
+  msg ("second leaves the real-time class: %s",
+       verdict (thread_set_realtime (0, 0)));
+  sema_up (&done_sema);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rt-admission) begin
+(rt-admission) main reserves 5 of 10 ticks: accepted
+(rt-admission) second reserves 5 of 10 ticks: rejected
+(rt-admission) second reserves 4 of 10 ticks: accepted
+(rt-admission) second leaves the real-time class: accepted
+(rt-admission) main asks for 10 of 10 ticks: rejected
+(rt-admission) main asks for 9 of 10 ticks: accepted
+(rt-admission) main asks for 3 of 2 ticks: rejected
+(rt-admission) main asks for 1 of 0 ticks: rejected
+(rt-admission) main asks for 3000000 of 3000000 ticks: rejected
+(rt-admission) main leaves the real-time class: accepted
+(rt-admission) end
+EOF
+pass;
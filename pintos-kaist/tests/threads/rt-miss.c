@@ -0,0 +1,75 @@
+/* Checks that a real-time thread kept from running past its
+   deadline has the miss counted by thread_get_rt_misses().
+
+   Admission control keeps real-time threads from starving each
+   other, so the overrun comes from the main thread, which spins
+   with interrupts off well past the real-time thread's wakeup
+   and deadline.  A sub-tick sleep in a helper thread keeps the
+   timer in one-shot mode meanwhile, so when interrupts come
+   back on the ticks that went by are replayed: the real-time
+   thread wakes and starts a period during the replay, and is
+   still waiting to run when that period ends. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* The real-time thread's reservation. */
+#define BUDGET 1
+#define PERIOD 2
+
+static thread_func rt_thread;
+static thread_func hr_thread;
+static struct semaphore done_sema;
+static int misses;
+
+void
+test_rt_miss (void) 
+{
+  enum intr_level old_level;
+  int64_t start;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done_sema, 0);
+
+  /* Both threads run at once and go to sleep. */
+  thread_create ("rt", PRI_DEFAULT + 1, rt_thread, NULL);
+  thread_create ("hr", PRI_DEFAULT + 1, hr_thread, NULL);
+
+  /* Spin for 10 ticks' worth of time with interrupts off. */
+  old_level = intr_disable ();
+  start = timer_ns ();
+  while (timer_ns () - start < 10 * (1000000000 / TIMER_FREQ))
+    continue;
+  intr_set_level (old_level);
+
+  sema_down (&done_sema);
+  sema_down (&done_sema);
+  if (misses < 1)
+    fail ("no deadline miss counted");
+  msg ("deadline miss counted");
+}
+
+static void
+rt_thread (void *aux UNUSED) 
+{
+  if (!thread_set_realtime (BUDGET, PERIOD))
+    fail ("reservation rejected");
+  timer_sleep (3);
+  misses = thread_get_rt_misses ();
+  thread_set_realtime (0, 0);
+  sema_up (&done_sema);
+}
+
+static void
+hr_thread (void *aux UNUSED) 
+{
+  timer_usleep (1000000 / TIMER_FREQ / 2);
+  sema_up (&done_sema);
+}
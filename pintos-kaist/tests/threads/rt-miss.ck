@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rt-miss) begin
+(rt-miss) deadline miss counted
+(rt-miss) end
+EOF
+pass;
@@ -0,0 +1,61 @@
+/* Checks that a real-time thread that uses up its budget is
+   throttled until the start of its next period and then runs
+   again.
+
+   The test thread reserves BUDGET of every PERIOD ticks and
+   spins, noting each tick it sees.  A run of ticks it did not
+   see is a throttle; each must end within a tick of a period
+   boundary. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define BUDGET 2
+#define PERIOD 10
+#define PERIOD_CNT 4
+
+void
+test_rt_throttle (void) 
+{
+  int64_t start, last;
+  int throttles = 0;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Start spinning right after a tick so that the reservation
+     starts at a known tick. */
+  last = timer_ticks ();
+  while (timer_ticks () == last)
+    continue;
+  start = timer_ticks ();
+  if (!thread_set_realtime (BUDGET, PERIOD))
+    fail ("reservation rejected");
+
+  last = start;
+  while (last - start < PERIOD_CNT * PERIOD) 
+    {
+      int64_t now = timer_ticks ();
+
+      if (now - last > 1) 
+        {
+          int64_t ofs = (now - start) % PERIOD;
+
+          if (now - last - 1 < PERIOD - BUDGET - 2)
+            fail ("throttled for only %"PRId64" ticks", now - last - 1);
+          if (ofs > 1 && ofs < PERIOD - 1)
+            fail ("resumed %"PRId64" ticks into a period", ofs);
+          throttles++;
+        }
+      last = now;
+    }
+  thread_set_realtime (0, 0);
+
+  if (throttles < PERIOD_CNT - 1)
+    fail ("throttled only %d times in %d periods", throttles, PERIOD_CNT);
+  msg ("throttled in each period and resumed at the next one");
+}
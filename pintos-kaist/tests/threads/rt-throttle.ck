@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rt-throttle) begin
+(rt-throttle) throttled in each period and resumed at the next one
+(rt-throttle) end
+EOF
+pass;
@@ -0,0 +1,132 @@
+/* Exercises the slab allocator.  Checks that a constructor runs
+   once per object, when its slab is built, and that the state it
+   set up survives a free and a new allocation.  Checks that a
+   cache whose objects are all freed keeps one empty slab and
+   hands every other page back, and that zeroed allocation
+   returns zeros. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/palloc.h"
+#include "threads/slab.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Object with a constructor. */
+struct counter
+  {
+    unsigned magic;             /* Set by the constructor. */
+    int uses;                   /* Kept across free and alloc. */
+  };
+
+#define COUNTER_MAGIC 0x0c0c0c0c
+
+/* Plain objects: enough of them to fill several slabs. */
+#define PLAIN_SIZE 100
+#define PLAIN_CNT 200
+
+static int ctor_calls;
+
+static void
+counter_ctor (void *obj_)
+{
+  struct counter *obj = obj_;
+
+  obj->magic = COUNTER_MAGIC;
+  obj->uses = 0;
+  ctor_calls++;
+}
+
+static size_t kernel_free_pages (void);
+
+void
+test_slab_cache (void)
+{
+  static void *plain[PLAIN_CNT];
+  struct kmem_cache *counters, *plains;
+  struct counter *c, *c2;
+  size_t free0, pages;
+  int calls, i;
+
+  counters = kmem_cache_create ("test_counter", sizeof *c, counter_ctor);
+  plains = kmem_cache_create ("test_plain", PLAIN_SIZE, NULL);
+  if (counters == NULL || plains == NULL)
+    fail ("kmem_cache_create failed");
+
+  /* Constructor state survives free and alloc. */
+  c = kmem_cache_alloc (counters);
+  if (c == NULL)
+    fail ("kmem_cache_alloc failed");
+  if (c->magic != COUNTER_MAGIC || c->uses != 0)
+    fail ("object was not constructed");
+  calls = ctor_calls;
+  c->uses = 5;
+  kmem_cache_free (counters, c);
+  c2 = kmem_cache_alloc (counters);
+  if (c2 != c)
+    fail ("freed object was not reused");
+  if (c2->magic != COUNTER_MAGIC || c2->uses != 5)
+    fail ("object lost its state across free");
+  if (ctor_calls != calls)
+    fail ("constructor ran again on a reused object");
+  kmem_cache_free (counters, c2);
+  msg ("constructed state kept across free");
+
+  /* Filling several slabs takes one page per slab. */
+  free0 = kernel_free_pages ();
+  for (i = 0; i < PLAIN_CNT; i++)
+    {
+      plain[i] = kmem_cache_alloc (plains);
+      if (plain[i] == NULL)
+        fail ("kmem_cache_alloc failed");
+      memset (plain[i], i, PLAIN_SIZE);
+    }
+  pages = free0 - kernel_free_pages ();
+  if (pages < 2 || pages > PLAIN_CNT * PLAIN_SIZE / (PGSIZE / 2))
+    fail ("%d objects of %d bytes took %zu pages",
+          PLAIN_CNT, PLAIN_SIZE, pages);
+  for (i = 0; i < PLAIN_CNT; i++)
+    {
+      const uint8_t *p = plain[i];
+      int j;
+
+      for (j = 0; j < PLAIN_SIZE; j++)
+        if (p[j] != (uint8_t) i)
+          fail ("object %d was overwritten", i);
+    }
+  msg ("objects fill several slabs without overlapping");
+
+  /* Freeing everything keeps exactly one empty slab. */
+  for (i = 0; i < PLAIN_CNT; i++)
+    kmem_cache_free (plains, plain[i]);
+  if (kernel_free_pages () != free0 - 1)
+    fail ("cache kept %zu pages after freeing everything, not 1",
+          free0 - kernel_free_pages ());
+  msg ("one empty slab kept");
+
+  /* The kept slab serves the next allocation. */
+  plain[0] = kmem_cache_zalloc (plains);
+  if (plain[0] == NULL)
+    fail ("kmem_cache_zalloc failed");
+  if (kernel_free_pages () != free0 - 1)
+    fail ("allocation did not reuse the empty slab");
+  for (i = 0; i < PLAIN_SIZE; i++)
+    if (((uint8_t *) plain[0])[i] != 0)
+      fail ("zeroed object is not zero");
+  kmem_cache_free (plains, plain[0]);
+  if (kernel_free_pages () != free0 - 1)
+    fail ("cache did not keep its empty slab");
+  msg ("empty slab reused");
+}
+
+/* Returns the number of free pages in the kernel pool. */
+static size_t
+kernel_free_pages (void)
+{
+  size_t free_pages, largest;
+
+  palloc_get_stats (0, &free_pages, &largest);
+  return free_pages;
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(slab-cache) begin
+(slab-cache) constructed state kept across free
+(slab-cache) objects fill several slabs without overlapping
+(slab-cache) one empty slab kept
+(slab-cache) empty slab reused
+(slab-cache) end
+EOF
+pass;
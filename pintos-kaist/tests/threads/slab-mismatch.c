@@ -0,0 +1,29 @@
+/* Frees an object to a cache other than the one it came from.
+   The slab allocator must notice and panic the kernel instead of
+   corrupting the other cache's free lists. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/slab.h"
+#include "threads/thread.h"
+
+void
+test_slab_mismatch (void)
+{
+  struct kmem_cache *a, *b;
+  void *obj;
+
+  a = kmem_cache_create ("test_a", 32, NULL);
+  b = kmem_cache_create ("test_b", 32, NULL);
+  if (a == NULL || b == NULL)
+    fail ("kmem_cache_create failed");
+
+  obj = kmem_cache_alloc (a);
+  if (obj == NULL)
+    fail ("kmem_cache_alloc failed");
+
+  msg ("freeing an object to the wrong cache");
+  kmem_cache_free (b, obj);
+  fail ("wrong cache not detected");
+}
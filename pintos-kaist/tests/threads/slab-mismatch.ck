@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+fail "missing test output"
+  unless grep ($_ eq '(slab-mismatch) freeing an object to the wrong cache',
+	       @output);
+fail "freeing to the wrong cache did not panic in obj_to_slab()"
+  unless grep (/PANIC at .* in obj_to_slab\(\): assertion `s->cache == c' failed/,
+	       @output);
+fail "freeing to the wrong cache returned"
+  if grep (/wrong cache not detected/, @output);
+
+pass;
@@ -0,0 +1,85 @@
+/* Checks that the stride scheduler (-stride) divides the CPU in
+   proportion to tickets.
+
+   Three threads with 300, 200 and 100 tickets spin for 10
+   seconds, counting the ticks they see.  Each should receive
+   its tickets' share of the ticks, within 10%, so that the
+   first gets about 3x the third. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 3
+
+struct thread_info 
+  {
+    int64_t start_time;
+    int tick_count;
+    int tickets;
+  };
+
+static void load_thread (void *aux);
+
+void
+test_stride_fair (void) 
+{
+  static const int tickets[THREAD_CNT] = {300, 200, 100};
+  struct thread_info info[THREAD_CNT];
+  int64_t start_time;
+  int total = 0;
+  int i;
+
+  ASSERT (thread_stride);
+
+  start_time = timer_ticks ();
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      struct thread_info *ti = &info[i];
+      char name[16];
+
+      ti->start_time = start_time;
+      ti->tick_count = 0;
+      ti->tickets = tickets[i];
+
+      snprintf (name, sizeof name, "load %d", i);
+      thread_create (name, PRI_DEFAULT, load_thread, ti);
+    }
+
+  msg ("Sleeping 12 seconds to let threads run, please wait...");
+  timer_sleep (12 * TIMER_FREQ);
+
+  for (i = 0; i < THREAD_CNT; i++)
+    total += info[i].tick_count;
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      int expected = total * tickets[i] / (300 + 200 + 100);
+      int diff = info[i].tick_count - expected;
+
+      if (diff < -expected / 10 || diff > expected / 10)
+        fail ("thread with %d tickets received %d of %d ticks, expected %d",
+              tickets[i], info[i].tick_count, total, expected);
+      msg ("Thread with %d tickets received its share.", tickets[i]);
+    }
+}
+
+static void
+load_thread (void *ti_) 
+{
+  struct thread_info *ti = ti_;
+  int64_t sleep_time = 1 * TIMER_FREQ;
+  int64_t spin_time = sleep_time + 10 * TIMER_FREQ;
+  int64_t last_time = 0;
+
+  thread_set_tickets (ti->tickets);
+  timer_sleep (sleep_time - timer_elapsed (ti->start_time));
+  while (timer_elapsed (ti->start_time) < spin_time) 
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        ti->tick_count++;
+      last_time = cur_time;
+    }
+}
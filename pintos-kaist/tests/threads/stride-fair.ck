@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(stride-fair) begin
+(stride-fair) Sleeping 12 seconds to let threads run, please wait...
+(stride-fair) Thread with 300 tickets received its share.
+(stride-fair) Thread with 200 tickets received its share.
+(stride-fair) Thread with 100 tickets received its share.
+(stride-fair) end
+EOF
+pass;
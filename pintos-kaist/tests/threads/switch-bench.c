@@ -0,0 +1,60 @@
+/* Measures the cost of a context switch.
+
+   The main thread and a second thread of the same priority take
+   turns on two semaphores, so each round trip is two switches
+   through sema_down() and schedule().  The time is read with
+   rdtsc() and reported as cycles per switch, including the
+   semaphore operations around it. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+/* Timed round trips.  One more is run first to get the second
+   thread started. */
+#define ROUNDS 10000
+
+static thread_func pong_thread;
+static struct semaphore ping_sema, pong_sema;
+
+void
+test_switch_bench (void) 
+{
+  uint64_t start, cycles;
+  int i;
+
+  sema_init (&ping_sema, 0);
+  sema_init (&pong_sema, 0);
+  thread_create ("pong", thread_get_priority (), pong_thread, NULL);
+
+  /* Warm up. */
+  sema_up (&ping_sema);
+  sema_down (&pong_sema);
+
+  start = rdtsc ();
+  for (i = 0; i < ROUNDS; i++) 
+    {
+      sema_up (&ping_sema);
+      sema_down (&pong_sema);
+    }
+  cycles = rdtsc () - start;
+
+  msg ("%d round trips, %d switches", ROUNDS, 2 * ROUNDS);
+  msg ("cycles per switch: %"PRIu64, cycles / (2 * ROUNDS));
+}
+
+static void
+pong_thread (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < ROUNDS + 1; i++) 
+    {
+      sema_down (&ping_sema);
+      sema_up (&pong_sema);
+    }
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+fail "missing round trip count in output"
+  unless grep ($_ eq '(switch-bench) 10000 round trips, 20000 switches',
+	       @output);
+fail "missing cycles per switch in output"
+  unless grep (/^\(switch-bench\) cycles per switch: \d+$/, @output);
+
+pass;
@@ -29,6 +29,15 @@ static const struct test tests[] =
     {"priority-preempt", test_priority_preempt},
     {"priority-sema", test_priority_sema},
     {"priority-condvar", test_priority_condvar},
+    {"rt-admission", test_rt_admission},
+    {"rt-throttle", test_rt_throttle},
+    {"rt-miss", test_rt_miss},
+    {"stride-fair", test_stride_fair},
+    {"switch-bench", test_switch_bench},
+    {"palloc-buddy", test_palloc_buddy},
+    {"slab-cache", test_slab_cache},
+    {"slab-mismatch", test_slab_mismatch},
+    {"workqueue", test_workqueue},
     {"mlfqs-load-1", test_mlfqs_load_1},
     {"mlfqs-load-60", test_mlfqs_load_60},
     {"mlfqs-load-avg", test_mlfqs_load_avg},
@@ -23,6 +23,15 @@ extern test_func test_priority_fifo;
 extern test_func test_priority_preempt;
 extern test_func test_priority_sema;
 extern test_func test_priority_condvar;
+extern test_func test_rt_admission;
+extern test_func test_rt_throttle;
+extern test_func test_rt_miss;
+extern test_func test_stride_fair;
+extern test_func test_switch_bench;
+extern test_func test_palloc_buddy;
+extern test_func test_slab_cache;
+extern test_func test_slab_mismatch;
+extern test_func test_workqueue;
 extern test_func test_mlfqs_load_1;
 extern test_func test_mlfqs_load_60;
 extern test_func test_mlfqs_load_avg;
@@ -0,0 +1,147 @@
+/* Exercises kernel workqueues: queued work runs in order and
+   only once however often it is queued before it starts, a
+   cancelled item does not run, delayed work runs only after its
+   delay and not at all if cancelled, and workqueue_flush() waits
+   for work that is already running.
+
+   The queue's worker runs below the main thread's priority, so
+   work only runs while the main thread is blocked. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+#define WORK_CNT 3
+#define DELAY 5
+
+/* A work item that records its id when it runs. */
+struct test_work
+  {
+    struct work work;
+    int id;
+  };
+
+static struct test_work works[WORK_CNT];
+static int run_log[WORK_CNT * 2];
+static int run_cnt;
+
+static struct delayed_work delayed;
+static int64_t delayed_ran_at;
+static struct semaphore delayed_sema;
+
+static struct work slow;
+static bool slow_done;
+
+static void record (struct work *);
+static void record_delayed (struct work *);
+static void sleep_then_finish (struct work *);
+
+void
+test_workqueue (void)
+{
+  struct workqueue *wq;
+  int64_t start;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  wq = workqueue_create ("test_wq", PRI_DEFAULT - 1, 1);
+  if (wq == NULL)
+    fail ("workqueue_create failed");
+  for (i = 0; i < WORK_CNT; i++)
+    {
+      work_init (&works[i].work, record);
+      works[i].id = i;
+    }
+
+  /* Work runs in queueing order, once. */
+  for (i = 0; i < WORK_CNT; i++)
+    if (!work_queue (wq, &works[i].work))
+      fail ("queueing work %d failed", i);
+  if (work_queue (wq, &works[0].work))
+    fail ("work 0 was queued twice");
+  workqueue_flush (wq);
+  if (run_cnt != WORK_CNT)
+    fail ("%d work items ran, not %d", run_cnt, WORK_CNT);
+  for (i = 0; i < WORK_CNT; i++)
+    if (run_log[i] != i)
+      fail ("work %d ran in place %d", run_log[i], i);
+  msg ("queued work ran once, in order");
+
+  /* A cancelled item does not run. */
+  run_cnt = 0;
+  work_queue (wq, &works[0].work);
+  work_queue (wq, &works[1].work);
+  if (!work_cancel (&works[1].work))
+    fail ("cancelling queued work failed");
+  if (work_cancel (&works[1].work))
+    fail ("work was cancelled twice");
+  workqueue_flush (wq);
+  if (run_cnt != 1 || run_log[0] != 0)
+    fail ("cancelled work ran");
+  msg ("cancelled work did not run");
+
+  /* Delayed work runs after its delay. */
+  sema_init (&delayed_sema, 0);
+  delayed_work_init (&delayed, record_delayed);
+  start = timer_ticks ();
+  if (!delayed_work_queue (wq, &delayed, DELAY))
+    fail ("queueing delayed work failed");
+  if (delayed_work_queue (wq, &delayed, DELAY))
+    fail ("delayed work was queued twice");
+  sema_down (&delayed_sema);
+  if (delayed_ran_at - start < DELAY)
+    fail ("delayed work ran after %lld ticks, not %d",
+          delayed_ran_at - start, DELAY);
+  msg ("delayed work ran after its delay");
+
+  /* Cancelled delayed work does not run. */
+  delayed_ran_at = 0;
+  if (!delayed_work_queue (wq, &delayed, DELAY))
+    fail ("queueing delayed work failed");
+  if (!delayed_work_cancel (&delayed))
+    fail ("cancelling delayed work failed");
+  timer_sleep (DELAY * 2);
+  workqueue_flush (wq);
+  if (delayed_ran_at != 0)
+    fail ("cancelled delayed work ran");
+  msg ("cancelled delayed work did not run");
+
+  /* Flush waits for work that sleeps. */
+  work_init (&slow, sleep_then_finish);
+  work_queue (wq, &slow);
+  workqueue_flush (wq);
+  if (!slow_done)
+    fail ("flush returned before running work finished");
+  msg ("flush waited for running work");
+}
+
+/* Appends the id of W's test_work to the run log. */
+static void
+record (struct work *w)
+{
+  struct test_work *tw = (struct test_work *) w;
+
+  run_log[run_cnt++] = tw->id;
+}
+
+/* Notes when the delayed work ran and wakes the main thread. */
+static void
+record_delayed (struct work *w UNUSED)
+{
+  delayed_ran_at = timer_ticks ();
+  sema_up (&delayed_sema);
+}
+
+/* Sleeps in the worker, then marks the slow work done. */
+static void
+sleep_then_finish (struct work *w UNUSED)
+{
+  timer_sleep (DELAY);
+  slow_done = true;
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue) begin
+(workqueue) queued work ran once, in order
+(workqueue) cancelled work did not run
+(workqueue) delayed work ran after its delay
+(workqueue) cancelled delayed work did not run
+(workqueue) flush waited for running work
+(workqueue) end
+EOF
+pass;
@@ -0,0 +1,14 @@
+/* Passes a kernel address to getrusage.
+   The process must be terminated with -1 exit code. */
+
+#include <rusage.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  getrusage (RUSAGE_SELF, (struct rusage *) 0x8004000000);
+  fail ("should have called exit(-1)");
+}
@@ -0,0 +1,16 @@
+/* Passes WHO values other than RUSAGE_SELF and RUSAGE_CHILDREN
+   to getrusage, which must fail with -1. */
+
+#include <rusage.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct rusage ru;
+
+  CHECK (getrusage (1, &ru) == -1, "getrusage(1) must fail");
+  CHECK (getrusage (-2, &ru) == -1, "getrusage(-2) must fail");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(getrusage-bad-who) begin
+(getrusage-bad-who) getrusage(1) must fail
+(getrusage-bad-who) getrusage(-2) must fail
+(getrusage-bad-who) end
+getrusage-bad-who: exit(0)
+EOF
+pass;
@@ -0,0 +1,45 @@
+/* Checks that getrusage(RUSAGE_CHILDREN) counts nothing before
+   a child has been waited for and the child's user time after. */
+
+#include <rusage.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Timer ticks of user time the child spends. */
+#define TICKS 3
+
+void
+test_main (void) 
+{
+  struct rusage ru;
+  int pid;
+
+  CHECK (getrusage (RUSAGE_CHILDREN, &ru) == 0, "getrusage(RUSAGE_CHILDREN)");
+  if (ru.utime != 0 || ru.stime != 0 || ru.nvcsw != 0 || ru.nivcsw != 0)
+    fail ("usage before any child exited");
+
+  if ((pid = fork ("child"))){
+    msg ("wait(child) = %d", wait (pid));
+  } else {
+    int i;
+
+    getrusage (RUSAGE_SELF, &ru);
+    for (i = 0; ru.utime < TICKS; i++)
+      {
+        volatile int spin;
+
+        if (i >= 100000)
+          fail ("utime stuck at %lld", ru.utime);
+        for (spin = 0; spin < 100000; spin++)
+          continue;
+        getrusage (RUSAGE_SELF, &ru);
+      }
+    exit (81);
+  }
+
+  CHECK (getrusage (RUSAGE_CHILDREN, &ru) == 0, "getrusage(RUSAGE_CHILDREN)");
+  if (ru.utime < TICKS)
+    fail ("children utime %lld, expected at least %d", ru.utime, TICKS);
+  msg ("children utime at least %d ticks", TICKS);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(getrusage-children) begin
+(getrusage-children) getrusage(RUSAGE_CHILDREN)
+child: exit(81)
+(getrusage-children) wait(child) = 81
+(getrusage-children) getrusage(RUSAGE_CHILDREN)
+(getrusage-children) children utime at least 3 ticks
+(getrusage-children) end
+getrusage-children: exit(0)
+EOF
+pass;
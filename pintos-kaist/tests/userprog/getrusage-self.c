@@ -0,0 +1,34 @@
+/* Spins in user mode and checks that getrusage(RUSAGE_SELF)
+   charges the time to the process as user time. */
+
+#include <rusage.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Timer ticks of user time to wait for. */
+#define TICKS 3
+
+void
+test_main (void) 
+{
+  struct rusage ru;
+  int i;
+
+  CHECK (getrusage (RUSAGE_SELF, &ru) == 0, "getrusage(RUSAGE_SELF)");
+  for (i = 0; ru.utime < TICKS; i++)
+    {
+      volatile int spin;
+
+      if (i >= 100000)
+        fail ("utime stuck at %lld", ru.utime);
+      for (spin = 0; spin < 100000; spin++)
+        continue;
+      getrusage (RUSAGE_SELF, &ru);
+    }
+  msg ("utime reached %d ticks", TICKS);
+
+  if (ru.stime < 0 || ru.wait_ns < 0 || ru.nvcsw < 0 || ru.nivcsw < 0)
+    fail ("negative usage: stime=%lld wait_ns=%lld nvcsw=%lld nivcsw=%lld",
+          ru.stime, ru.wait_ns, ru.nvcsw, ru.nivcsw);
+}
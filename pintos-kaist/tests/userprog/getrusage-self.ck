@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(getrusage-self) begin
+(getrusage-self) getrusage(RUSAGE_SELF)
+(getrusage-self) utime reached 3 ticks
+(getrusage-self) end
+getrusage-self: exit(0)
+EOF
+pass;
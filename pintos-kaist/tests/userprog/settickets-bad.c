@@ -0,0 +1,16 @@
+/* Passes ticket counts outside 1...10000 to settickets, which
+   must fail with -1 and leave the tickets unchanged. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  CHECK (settickets (0) == -1, "settickets(0) must fail");
+  CHECK (settickets (-100) == -1, "settickets(-100) must fail");
+  CHECK (settickets (10001) == -1, "settickets(10001) must fail");
+  CHECK (settickets (300) == 100, "settickets(300) returns the old 100");
+  CHECK (settickets (10000) == 300, "settickets(10000) returns the old 300");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(settickets-bad) begin
+(settickets-bad) settickets(0) must fail
+(settickets-bad) settickets(-100) must fail
+(settickets-bad) settickets(10001) must fail
+(settickets-bad) settickets(300) returns the old 100
+(settickets-bad) settickets(10000) returns the old 300
+(settickets-bad) end
+settickets-bad: exit(0)
+EOF
+pass;
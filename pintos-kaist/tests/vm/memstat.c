@@ -0,0 +1,90 @@
+/* Checks that the memstat system call tracks the process's
+   memory: resident pages after touching anonymous memory, a
+   file-backed page after reading a mapping, and swapped pages
+   and major faults after touching more memory than fits in
+   physical memory.  For this test, Pintos memory size is
+   10MB. */
+
+#include <memstat.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define ONE_MB (1 << 20)
+#define CHUNK_SIZE (20 * ONE_MB)
+#define PAGE_COUNT (CHUNK_SIZE / PAGE_SIZE)
+
+/* Anonymous pages touched before anything is swapped. */
+#define TOUCH_CNT 64
+
+static char big_chunks[CHUNK_SIZE];
+
+void
+test_main (void)
+{
+  char *actual = (char *) 0x10000000;
+  struct memstat before, after;
+  int handle;
+  void *map;
+  size_t i;
+
+  /* Touching anonymous pages makes them resident. */
+  CHECK (memstat (&before) == 0, "memstat");
+  for (i = 0; i < TOUCH_CNT; i++)
+    big_chunks[i * PAGE_SIZE] = (char) i;
+  memstat (&after);
+  if (after.rss < before.rss + TOUCH_CNT)
+    fail ("rss went from %llu to %llu after touching %d pages",
+          before.rss, after.rss, TOUCH_CNT);
+  if (after.minor_faults + after.major_faults
+      < before.minor_faults + before.major_faults + TOUCH_CNT)
+    fail ("fewer than %d faults counted for %d new pages",
+          TOUCH_CNT, TOUCH_CNT);
+  msg ("rss grew by at least %d pages", TOUCH_CNT);
+
+  /* Reading a mapped file brings in a file-backed page from disk. */
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((map = mmap (actual, 4096, 0, handle, 0)) != MAP_FAILED,
+         "mmap \"sample.txt\"");
+  before = after;
+  if (memcmp (actual, sample, strlen (sample)))
+    fail ("read of mmap'd file reported bad data");
+  memstat (&after);
+  if (after.file_pages < before.file_pages + 1)
+    fail ("file pages went from %llu to %llu after reading a mapping",
+          before.file_pages, after.file_pages);
+  if (after.major_faults < before.major_faults + 1)
+    fail ("reading a mapping was not a major fault");
+  msg ("mapped page counted as a file page and a major fault");
+
+  before = after;
+  munmap (map);
+  close (handle);
+  memstat (&after);
+  if (after.file_pages != before.file_pages - 1)
+    fail ("file pages went from %llu to %llu after munmap",
+          before.file_pages, after.file_pages);
+  msg ("munmap released the file page");
+
+  /* Touching more than fits in memory pushes pages to swap, and
+     reading them back is a major fault. */
+  for (i = TOUCH_CNT; i < PAGE_COUNT; i++)
+    big_chunks[i * PAGE_SIZE] = (char) i;
+  memstat (&before);
+  if (before.swapped == 0)
+    fail ("no pages swapped after touching %d pages", PAGE_COUNT);
+  if (before.rss >= PAGE_COUNT)
+    fail ("rss %llu exceeds physical memory", before.rss);
+  msg ("pages went to swap");
+
+  for (i = 0; i < TOUCH_CNT; i++)
+    if (big_chunks[i * PAGE_SIZE] != (char) i)
+      fail ("data is inconsistent in page %zu", i);
+  memstat (&after);
+  if (after.major_faults <= before.major_faults)
+    fail ("reading swapped pages back was not a major fault");
+  msg ("swap-in counted as major faults");
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(memstat) begin
+(memstat) memstat
+(memstat) rss grew by at least 64 pages
+(memstat) open "sample.txt"
+(memstat) mmap "sample.txt"
+(memstat) mapped page counted as a file page and a major fault
+(memstat) munmap released the file page
+(memstat) pages went to swap
+(memstat) swap-in counted as major faults
+(memstat) end
+EOF
+pass;
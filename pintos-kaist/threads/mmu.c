@@ -2,12 +2,38 @@
 #include <stddef.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "intrinsic.h"
 
+/* Process-context identifiers (PCIDs).
+ *
+ * When the CPU supports them, every pml4 is tagged with a PCID
+ * that is loaded into the low 12 bits of CR3, so switching
+ * between processes keeps each one's TLB entries instead of
+ * flushing them.  PCID 0 belongs to base_pml4; the others are
+ * handed out on activation and recycled round-robin when they
+ * run out.  A pml4 that receives a PCID, or whose PTEs changed
+ * while it was not loaded, is activated with a flushing CR3
+ * write so that no stale translation survives. */
+#define CR3_PCID_MASK 0xfffULL          /* CR3 bits holding the PCID. */
+#define CR3_NOFLUSH (1ULL << 63)        /* Keep the PCID's TLB entries. */
+#define CR4_PCIDE (1 << 17)             /* CR4 PCID enable. */
+#define CPUID_ECX_PCID (1 << 17)        /* CPUID.01H:ECX PCID support. */
+#define PCID_CNT 64                     /* PCIDs in use, including 0. */
+
+struct pcid_slot {
+	uint64_t *pml4;                 /* Owner, or NULL if free. */
+	bool stale;                     /* Owner's PTEs changed while inactive. */
+};
+
+static bool pcid_enabled;
+static struct pcid_slot pcid_slots[PCID_CNT];
+static unsigned pcid_victim = 1;        /* Next PCID to recycle. */
+
 static uint64_t *
 pgdir_walk (uint64_t *pdp, const uint64_t va, int create) {
 	int idx = PDX (va);
@@ -22,7 +48,9 @@ pgdir_walk (uint64_t *pdp, const uint64_t va, int create) {
 					return NULL;
 			} else
 				return NULL;
-		}
+		} else if ((uint64_t) pte & PTE_PS)
+			/* Covered by a 2 MB page: there is no 4 KB PTE. */
+			return NULL;
 		return (uint64_t *) ptov (PTE_ADDR (pdp[idx]) + 8 * PTX (va));
 	}
 	return NULL;
@@ -88,6 +116,27 @@ pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
 	return pte;
 }
 
+/* Returns the page directory entry for virtual address VA in
+ * PML4, creating missing intermediate tables if CREATE is true.
+ * Used to install 2 MB pages.  Returns a null pointer if a table
+ * is missing and CREATE is false, or if allocation fails. */
+uint64_t *
+pml4e_walk_pde (uint64_t *pml4, const uint64_t va, int create) {
+	uint64_t *table = pml4;
+	int idx[2] = { PML4 (va), PDPE (va) };
+
+	for (int i = 0; i < 2; i++) {
+		if (!(table[idx[i]] & PTE_P)) {
+			uint64_t *new_page;
+			if (!create || (new_page = palloc_get_page (PAL_ZERO)) == NULL)
+				return NULL;
+			table[idx[i]] = vtop (new_page) | PTE_U | PTE_W | PTE_P;
+		}
+		table = ptov (PTE_ADDR (table[idx[i]]));
+	}
+	return &table[PDX (va)];
+}
+
 /* Creates a new page map level 4 (pml4) has mappings for kernel
  * virtual addresses, but none for user virtual addresses.
  * Returns the new page directory, or a null pointer if memory
@@ -122,7 +171,7 @@ pgdir_for_each (uint64_t *pdp, pte_for_each_func *func, void *aux,
 		unsigned pml4_index, unsigned pdp_index) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pdp[i]);
-		if (((uint64_t) pte) & PTE_P)
+		if ((((uint64_t) pte) & PTE_P) && !(((uint64_t) pte) & PTE_PS))
 			if (!pt_for_each ((uint64_t *) PTE_ADDR (pte), func, aux,
 					pml4_index, pdp_index, i))
 				return false;
@@ -196,14 +245,128 @@ pml4_destroy (uint64_t *pml4) {
 	uint64_t *pdpe = ptov ((uint64_t *) pml4[0]);
 	if (((uint64_t) pdpe) & PTE_P)
 		pdpe_destroy ((void *) PTE_ADDR (pdpe));
+	pcid_release (pml4);
 	palloc_free_page ((void *) pml4);
 }
 
+/* Enables PCIDs if the CPU supports them.  Must be called while
+ * base_pml4 is loaded with PCID 0. */
+void
+pcid_init (void) {
+	uint32_t regs[4];
+
+	cpuid (1, regs);
+	if (!(regs[2] & CPUID_ECX_PCID))
+		return;
+
+	ASSERT ((rcr3 () & CR3_PCID_MASK) == 0);
+	lcr4 (rcr4 () | CR4_PCIDE);
+	pcid_slots[0].pml4 = base_pml4;
+	pcid_enabled = true;
+}
+
+/* Returns the PCID assigned to PML4, assigning one if it has
+ * none.  Sets *FLUSH to true if the PCID's TLB entries must be
+ * discarded on the next CR3 load.  Interrupts must be off. */
+static unsigned
+pcid_get (uint64_t *pml4, bool *flush) {
+	struct pcid_slot *slot;
+	unsigned free = 0;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (unsigned i = 1; i < PCID_CNT; i++) {
+		slot = &pcid_slots[i];
+		if (slot->pml4 == pml4) {
+			*flush = slot->stale;
+			slot->stale = false;
+			return i;
+		}
+		if (slot->pml4 == NULL && free == 0)
+			free = i;
+	}
+
+	/* No PCID yet: take a free one, or steal the next victim.
+	 * The victim's owner gets a fresh PCID when it runs again. */
+	if (free == 0) {
+		free = pcid_victim;
+		pcid_victim = pcid_victim + 1 < PCID_CNT ? pcid_victim + 1 : 1;
+	}
+	slot = &pcid_slots[free];
+	slot->pml4 = pml4;
+	slot->stale = false;
+	*flush = true;
+	return free;
+}
+
+/* Gives up the PCID held by PML4, if any.  Entries left in the
+ * TLB under that PCID are flushed when it is next assigned. */
+void
+pcid_release (uint64_t *pml4) {
+	if (!pcid_enabled)
+		return;
+
+	enum intr_level old_level = intr_disable ();
+	for (unsigned i = 1; i < PCID_CNT; i++)
+		if (pcid_slots[i].pml4 == pml4) {
+			pcid_slots[i].pml4 = NULL;
+			break;
+		}
+	intr_set_level (old_level);
+}
+
+/* Forces PML4's TLB entries to be flushed the next time PML4 is
+ * activated. */
+static void
+pcid_mark_stale (uint64_t *pml4) {
+	enum intr_level old_level = intr_disable ();
+	for (unsigned i = 1; i < PCID_CNT; i++)
+		if (pcid_slots[i].pml4 == pml4) {
+			pcid_slots[i].stale = true;
+			break;
+		}
+	intr_set_level (old_level);
+}
+
 /* Loads page directory PD into the CPU's page directory base
- * register. */
+ * register.  With PCIDs enabled, the TLB entries of PML4 that are
+ * still valid survive the switch. */
 void
 pml4_activate (uint64_t *pml4) {
-	lcr3 (vtop (pml4 ? pml4 : base_pml4));
+	if (!pcid_enabled) {
+		lcr3 (vtop (pml4 ? pml4 : base_pml4));
+		return;
+	}
+
+	/* Kernel mappings never change, so base_pml4 (PCID 0) is
+	 * always loaded without a flush. */
+	if (pml4 == NULL || pml4 == base_pml4) {
+		lcr3 (vtop (base_pml4) | CR3_NOFLUSH);
+		return;
+	}
+
+	enum intr_level old_level = intr_disable ();
+	bool flush;
+	unsigned pcid = pcid_get (pml4, &flush);
+	lcr3 (vtop (pml4) | pcid | (flush ? 0 : CR3_NOFLUSH));
+	intr_set_level (old_level);
+}
+
+/* Returns true if PML4 is the page table currently loaded in CR3. */
+static bool
+is_active (uint64_t *pml4) {
+	return (rcr3 () & ~CR3_PCID_MASK) == vtop (pml4);
+}
+
+/* Drops any cached translation of VA in PML4.  Translations of an
+ * inactive pml4 may still be cached under its PCID, so that PCID
+ * is flushed when PML4 is next activated. */
+static void
+tlb_invalidate (uint64_t *pml4, uint64_t va) {
+	if (is_active (pml4))
+		invlpg (va);
+	else if (pcid_enabled)
+		pcid_mark_stale (pml4);
 }
 
 /* Looks up the physical address that corresponds to user virtual
@@ -257,8 +420,7 @@ pml4_clear_page (uint64_t *pml4, void *upage) {
 
 	if (pte != NULL && (*pte & PTE_P) != 0) {
 		*pte &= ~PTE_P;
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) upage);
+		tlb_invalidate (pml4, (uint64_t) upage);
 	}
 }
 
@@ -283,8 +445,7 @@ pml4_set_dirty (uint64_t *pml4, const void *vpage, bool dirty) {
 		else
 			*pte &= ~(uint32_t) PTE_D;
 
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) vpage);
+		tlb_invalidate (pml4, (uint64_t) vpage);
 	}
 }
 
@@ -309,7 +470,9 @@ pml4_set_accessed (uint64_t *pml4, const void *vpage, bool accessed) {
 		else
 			*pte &= ~(uint32_t) PTE_A;
 
-		if (rcr3 () == vtop (pml4))
+		/* A stale entry only delays the accessed bit being set
+		 * again, so an inactive pml4 is not flushed for it. */
+		if (is_active (pml4))
 			invlpg ((uint64_t) vpage);
 	}
 }
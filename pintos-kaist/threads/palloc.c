@@ -2,6 +2,7 @@
 #include <bitmap.h>
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -24,13 +25,64 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   Within a pool, free pages are managed by a binary buddy
+   allocator.  Free memory is kept as blocks of 2**ORDER pages
+   whose page index within the pool is a multiple of 2**ORDER,
+   one free list per order.  A request for N pages takes a block
+   of the smallest order that fits, splitting larger blocks in
+   half as needed, and gives the unused tail back.  A freed block
+   is merged with its "buddy", the other half of the block it was
+   split from, for as long as the buddy is free too.  Both take
+   O(log n) steps, where the old first-fit bitmap scan took
+   O(n * N).
+
+   A free block's list element lives in its first page.  Whether
+   a page heads a free block, and of what order, is recorded
+   outside the pages in ORDER_MAP, so that merging never trusts
+   the contents of a page that may be in use.  USED_MAP still
+   tracks every page, to catch double frees.
+
+   Each pool also keeps a few free pages that are already filled
+   with zeros, so that a PAL_ZERO request for one page can skip
+   the memset().  The idle thread takes pages off the free lists,
+   zeroes them and adds them to the ZEROED list, up to
+   ZEROED_MAX.  These pages count as used in USED_MAP.  When the
+   free lists run dry, allocations fall back on the zeroed pages,
+   so none of the pool's memory is lost to them. */
+
+/* Number of block orders: blocks are 1 to 2**(ORDER_CNT - 1)
+   pages. */
+#define ORDER_CNT 20
+
+/* Maximum number of pre-zeroed pages per pool. */
+#define ZEROED_MAX 64
 
 /* A memory pool. */
 struct pool {
-	struct lock lock;               /* Mutual exclusion. */
+	struct spinlock lock;           /* Mutual exclusion. */
 	struct bitmap *used_map;        /* Bitmap of free pages. */
 	uint8_t *base;                  /* Base of pool. */
+	uint8_t *order_map;             /* Per page: order + 1 if it heads
+	                                   a free block, otherwise 0. */
+	struct list free_lists[ORDER_CNT];  /* Free blocks, by order. */
+	size_t free_blocks[ORDER_CNT];  /* Length of each free list. */
+	size_t free_pages;              /* Pages in all free blocks. */
+	unsigned long long splits;      /* Blocks split in two. */
+	unsigned long long merges;      /* Buddies merged. */
+
+	struct list zeroed;             /* Pre-zeroed pages. */
+	size_t zeroed_cnt;              /* Length of ZEROED. */
+	unsigned long long zero_hits;   /* PAL_ZERO served from ZEROED. */
+	unsigned long long zero_misses; /* PAL_ZERO that needed memset(). */
+	unsigned long long zero_fills;  /* Pages zeroed by the idle thread. */
+};
+
+/* Free block, stored in its first page.  A pre-zeroed page
+   stores one too; it is cleared when the page is handed out. */
+struct free_block {
+	struct list_elem elem;          /* Element in a free or zeroed list. */
 };
 
 /* Two pools: one for kernel data, one for user pages. */
@@ -42,6 +94,13 @@ static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end);
 
 static bool page_from_pool (const struct pool *, void *page);
+static void init_free_lists (struct pool *);
+static size_t buddy_alloc (struct pool *, size_t page_cnt);
+static void buddy_free (struct pool *, size_t page_idx, size_t page_cnt);
+static void *take_zeroed (struct pool *);
+static void drain_zeroed (struct pool *);
+static bool fill_zeroed (struct pool *);
+static void print_pool_stats (const char *name, struct pool *);
 
 /* multiboot info */
 struct multiboot_info {
@@ -232,6 +291,9 @@ split:
 			}
 		}
 	}
+
+	init_free_lists (&kernel_pool);
+	init_free_lists (&user_pool);
 }
 
 /* Initializes the page allocator and get the memory size */
@@ -262,19 +324,37 @@ palloc_init (void) {
 void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
-
-	lock_acquire (&pool->lock);
-	size_t page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-	lock_release (&pool->lock);
-	void *pages;
-
-	if (page_idx != BITMAP_ERROR)
-		pages = pool->base + PGSIZE * page_idx;
-	else
-		pages = NULL;
+	void *pages = NULL;
+	bool zeroed = false;
+
+	spin_lock (&pool->lock);
+	if (page_cnt == 1 && (flags & PAL_ZERO) && pool->zeroed_cnt > 0) {
+		pages = take_zeroed (pool);
+		zeroed = true;
+		pool->zero_hits++;
+	} else {
+		size_t page_idx = buddy_alloc (pool, page_cnt);
+
+		/* Out of free blocks: use up the pre-zeroed pages. */
+		if (page_idx == BITMAP_ERROR && pool->zeroed_cnt > 0) {
+			if (page_cnt == 1)
+				pages = take_zeroed (pool);
+			else {
+				drain_zeroed (pool);
+				page_idx = buddy_alloc (pool, page_cnt);
+			}
+		}
+		if (page_idx != BITMAP_ERROR) {
+			bitmap_set_multiple (pool->used_map, page_idx, page_cnt, true);
+			pages = pool->base + PGSIZE * page_idx;
+		}
+		if (pages != NULL && (flags & PAL_ZERO))
+			pool->zero_misses++;
+	}
+	spin_unlock (&pool->lock);
 
 	if (pages) {
-		if (flags & PAL_ZERO)
+		if ((flags & PAL_ZERO) && !zeroed)
 			memset (pages, 0, PGSIZE * page_cnt);
 	} else {
 		if (flags & PAL_ASSERT)
@@ -318,8 +398,11 @@ palloc_free_multiple (void *pages, size_t page_cnt) {
 #ifndef NDEBUG
 	memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
+	spin_lock (&pool->lock);
 	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
 	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+	buddy_free (pool, page_idx, page_cnt);
+	spin_unlock (&pool->lock);
 }
 
 /* Frees the page at PAGE. */
@@ -331,15 +414,30 @@ palloc_free_page (void *page) {
 /* Initializes pool P as starting at START and ending at END */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
+  /* We'll put the pool's used_map at its base, followed by its
+     order_map.  Calculate the space needed for both
      and subtract it from the pool's size. */
 	uint64_t pgcnt = (end - start) / PGSIZE;
-	size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (pgcnt), PGSIZE) * PGSIZE;
+	size_t bm_size = bitmap_buf_size (pgcnt);
+	size_t bm_pages = DIV_ROUND_UP (bm_size + pgcnt, PGSIZE) * PGSIZE;
+	int order;
 
-	lock_init(&p->lock);
-	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_pages);
+	spin_lock_init (&p->lock);
+	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_size);
 	p->base = (void *) start;
+	p->order_map = (uint8_t *) *bm_base + bm_size;
+	memset (p->order_map, 0, pgcnt);
+
+	for (order = 0; order < ORDER_CNT; order++) {
+		list_init (&p->free_lists[order]);
+		p->free_blocks[order] = 0;
+	}
+	p->free_pages = 0;
+	p->splits = p->merges = 0;
+
+	list_init (&p->zeroed);
+	p->zeroed_cnt = 0;
+	p->zero_hits = p->zero_misses = p->zero_fills = 0;
 
 	// Mark all to unusable.
 	bitmap_set_all(p->used_map, true);
@@ -347,6 +445,267 @@ init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
 	*bm_base += bm_pages;
 }
 
+/* Puts every page that populate_pools() marked usable in pool P
+   onto P's free lists. */
+static void
+init_free_lists (struct pool *p) {
+	size_t page_cnt = bitmap_size (p->used_map);
+	size_t start = 0;
+
+	while (start < page_cnt) {
+		size_t end;
+
+		start = bitmap_scan (p->used_map, start, 1, false);
+		if (start == BITMAP_ERROR)
+			break;
+		end = bitmap_scan (p->used_map, start, 1, true);
+		if (end == BITMAP_ERROR)
+			end = page_cnt;
+		buddy_free (p, start, end - start);
+		start = end;
+	}
+}
+
+/* Returns the first page of block PAGE_IDX in pool P. */
+static struct free_block *
+idx_to_block (struct pool *p, size_t page_idx) {
+	return (struct free_block *) (p->base + PGSIZE * page_idx);
+}
+
+/* Adds the block of 2**ORDER pages at PAGE_IDX to P's free
+   lists, without merging. */
+static void
+push_block (struct pool *p, size_t page_idx, int order) {
+	p->order_map[page_idx] = order + 1;
+	list_push_front (&p->free_lists[order], &idx_to_block (p, page_idx)->elem);
+	p->free_blocks[order]++;
+	p->free_pages += (size_t) 1 << order;
+}
+
+/* Takes the free block of 2**ORDER pages at PAGE_IDX off P's free
+   lists. */
+static void
+remove_block (struct pool *p, size_t page_idx, int order) {
+	ASSERT (p->order_map[page_idx] == order + 1);
+
+	p->order_map[page_idx] = 0;
+	list_remove (&idx_to_block (p, page_idx)->elem);
+	p->free_blocks[order]--;
+	p->free_pages -= (size_t) 1 << order;
+}
+
+/* Returns the smallest order whose blocks hold PAGE_CNT pages. */
+static int
+order_for (size_t page_cnt) {
+	int order = 0;
+
+	while (((size_t) 1 << order) < page_cnt)
+		order++;
+	return order;
+}
+
+/* Removes PAGE_CNT contiguous pages from P's free lists and
+   returns the index of the first, or BITMAP_ERROR if no free
+   block is big enough. */
+static size_t
+buddy_alloc (struct pool *p, size_t page_cnt) {
+	int want = order_for (page_cnt);
+	int order;
+	size_t page_idx;
+	size_t block_cnt;
+
+	if (page_cnt == 0 || want >= ORDER_CNT)
+		return BITMAP_ERROR;
+
+	for (order = want; order < ORDER_CNT; order++)
+		if (!list_empty (&p->free_lists[order]))
+			break;
+	if (order == ORDER_CNT)
+		return BITMAP_ERROR;
+
+	page_idx = pg_no (list_entry (list_front (&p->free_lists[order]),
+	                              struct free_block, elem))
+		- pg_no (p->base);
+	remove_block (p, page_idx, order);
+
+	/* Split off the upper halves until the block is no bigger
+	   than needed. */
+	while (order > want) {
+		order--;
+		push_block (p, page_idx + ((size_t) 1 << order), order);
+		p->splits++;
+	}
+
+	/* Give back the pages past PAGE_CNT. */
+	block_cnt = (size_t) 1 << order;
+	if (block_cnt > page_cnt)
+		buddy_free (p, page_idx + page_cnt, block_cnt - page_cnt);
+	return page_idx;
+}
+
+/* Returns the PAGE_CNT pages at PAGE_IDX to P's free lists,
+   merging each aligned block with its buddy as far as possible. */
+static void
+buddy_free (struct pool *p, size_t page_idx, size_t page_cnt) {
+	size_t pool_cnt = bitmap_size (p->used_map);
+	size_t end = page_idx + page_cnt;
+
+	while (page_idx < end) {
+		size_t idx = page_idx;
+		int order = 0;
+
+		/* Largest aligned block that starts at PAGE_IDX and fits. */
+		while (order + 1 < ORDER_CNT
+		       && idx % ((size_t) 1 << (order + 1)) == 0
+		       && idx + ((size_t) 1 << (order + 1)) <= end)
+			order++;
+		page_idx += (size_t) 1 << order;
+
+		for (; order + 1 < ORDER_CNT; order++) {
+			size_t buddy = idx ^ ((size_t) 1 << order);
+
+			if (buddy + ((size_t) 1 << order) > pool_cnt
+			    || p->order_map[buddy] != order + 1)
+				break;
+			remove_block (p, buddy, order);
+			if (buddy < idx)
+				idx = buddy;
+			p->merges++;
+		}
+		push_block (p, idx, order);
+	}
+}
+
+/* Zeroes one free page and adds it to its pool's pre-zeroed
+   pages, kernel pool first.  Returns false if there was nothing
+   to do because every pool has ZEROED_MAX pre-zeroed pages or no
+   free page.  Called by the idle thread; never sleeps. */
+bool
+palloc_prezero (void) {
+	return fill_zeroed (&kernel_pool) || fill_zeroed (&user_pool);
+}
+
+/* Takes a page off P's pre-zeroed pages and returns it, all
+   zeros.  P's lock must be held. */
+static void *
+take_zeroed (struct pool *p) {
+	struct free_block *b;
+
+	ASSERT (p->zeroed_cnt > 0);
+
+	b = list_entry (list_pop_front (&p->zeroed), struct free_block, elem);
+	p->zeroed_cnt--;
+	memset (b, 0, sizeof *b);
+	return b;
+}
+
+/* Returns all of P's pre-zeroed pages to its free lists.  P's
+   lock must be held. */
+static void
+drain_zeroed (struct pool *p) {
+	while (p->zeroed_cnt > 0) {
+		size_t page_idx = pg_no (take_zeroed (p)) - pg_no (p->base);
+
+		bitmap_reset (p->used_map, page_idx);
+		buddy_free (p, page_idx, 1);
+	}
+}
+
+/* Moves one page from P's free lists to its pre-zeroed pages,
+   zeroing it without holding the lock.  Returns true if it did. */
+static bool
+fill_zeroed (struct pool *p) {
+	size_t page_idx;
+	struct free_block *b;
+
+	spin_lock (&p->lock);
+	page_idx = p->zeroed_cnt < ZEROED_MAX ? buddy_alloc (p, 1) : BITMAP_ERROR;
+	if (page_idx != BITMAP_ERROR)
+		bitmap_mark (p->used_map, page_idx);
+	spin_unlock (&p->lock);
+	if (page_idx == BITMAP_ERROR)
+		return false;
+
+	b = (struct free_block *) (p->base + PGSIZE * page_idx);
+	memset (b, 0, PGSIZE);
+
+	spin_lock (&p->lock);
+	list_push_front (&p->zeroed, &b->elem);
+	p->zeroed_cnt++;
+	p->zero_fills++;
+	spin_unlock (&p->lock);
+	return true;
+}
+
+/* Prints fragmentation statistics for the page pools. */
+void
+palloc_print_stats (void) {
+	print_pool_stats ("Kernel", &kernel_pool);
+	print_pool_stats ("User", &user_pool);
+}
+
+/* Stores the number of free pages in the user pool if PAL_USER
+   is set in FLAGS, otherwise in the kernel pool, into *FREE_PAGES,
+   and the size in pages of its largest free block, or 0, into
+   *LARGEST.  Pre-zeroed pages are not counted. */
+void
+palloc_get_stats (enum palloc_flags flags, size_t *free_pages,
+                  size_t *largest) {
+	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+	int order;
+
+	spin_lock (&pool->lock);
+	*free_pages = pool->free_pages;
+	*largest = 0;
+	for (order = ORDER_CNT - 1; order >= 0; order--)
+		if (pool->free_blocks[order] > 0) {
+			*largest = (size_t) 1 << order;
+			break;
+		}
+	spin_unlock (&pool->lock);
+}
+
+/* Prints fragmentation statistics for pool P, called NAME.
+   The counters are copied under the lock and printed after. */
+static void
+print_pool_stats (const char *name, struct pool *p) {
+	size_t free_blocks[ORDER_CNT];
+	size_t free_pages, zeroed_cnt, blocks = 0;
+	unsigned long long splits, merges, zero_hits, zero_misses, zero_fills;
+	int largest = -1;
+	int order;
+
+	spin_lock (&p->lock);
+	memcpy (free_blocks, p->free_blocks, sizeof free_blocks);
+	free_pages = p->free_pages;
+	splits = p->splits;
+	merges = p->merges;
+	zeroed_cnt = p->zeroed_cnt;
+	zero_hits = p->zero_hits;
+	zero_misses = p->zero_misses;
+	zero_fills = p->zero_fills;
+	spin_unlock (&p->lock);
+
+	printf ("%s pool: %zu of %zu pages free, blocks by order:", name,
+	        free_pages, bitmap_size (p->used_map));
+	for (order = 0; order < ORDER_CNT; order++)
+		if (free_blocks[order] > 0) {
+			printf (" %d:%zu", order, free_blocks[order]);
+			blocks += free_blocks[order];
+			largest = order;
+		}
+	printf ("\n");
+	if (largest >= 0)
+		printf ("%s pool: %zu free blocks, largest %zu pages, "
+		        "%zu%% fragmented, %llu splits, %llu merges\n",
+		        name, blocks, (size_t) 1 << largest,
+		        100 - ((size_t) 100 << largest) / free_pages,
+		        splits, merges);
+	printf ("%s pool: %zu pre-zeroed pages, %llu zeroed by idle, "
+	        "%llu zero hits, %llu zero misses\n",
+	        name, zeroed_cnt, zero_fills, zero_hits, zero_misses);
+}
+
 /* Returns true if PAGE was allocated from POOL,
    false otherwise. */
 static bool
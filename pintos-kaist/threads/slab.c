@@ -0,0 +1,298 @@
+#include "threads/slab.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Slab allocator.
+
+   Each slab is one page from the page allocator.  It starts with
+   a struct slab header and the rest is cut into objects of the
+   cache's stride, the object size rounded up for alignment.
+   Free objects in a slab are chained through a link word: the
+   object's first word, or, if the cache has a constructor whose
+   work must survive, a word just past the object.
+
+   A cache keeps its slabs on three lists by how many objects are
+   in use: partial slabs are allocated from first, then an empty
+   slab, and only then is a new page requested.  One empty slab
+   is kept when its last object is freed so that a cache that
+   oscillates around a page boundary does not hit the page
+   allocator each time; further empty slabs go back at once.
+
+   kmem_cache_free() finds an object's slab by rounding its
+   address down to the page, the same trick as malloc()'s
+   arenas. */
+
+/* A cache of objects of one size. */
+struct kmem_cache {
+	const char *name;           /* Name, for statistics. */
+	size_t size;                /* Object size as requested. */
+	size_t stride;              /* Distance between objects. */
+	size_t link_ofs;            /* Offset of the free list link. */
+	size_t objs_per_slab;       /* Objects in one slab. */
+	kmem_ctor_func *ctor;       /* Constructor, or null. */
+
+	struct lock lock;           /* Guards everything below. */
+	char lock_name[32];         /* Lock class name. */
+	struct list partial;        /* Slabs with some objects free. */
+	struct list full;           /* Slabs with no objects free. */
+	struct list empty;          /* Slabs with all objects free. */
+
+	/* Statistics. */
+	unsigned long long allocs;  /* Successful allocations. */
+	unsigned long long frees;   /* Frees. */
+	size_t active;              /* Objects in use. */
+	size_t peak;                /* Most objects in use at once. */
+	size_t slabs;               /* Pages owned. */
+};
+
+/* Magic number for detecting slab corruption. */
+#define SLAB_MAGIC 0x5ab1a110
+
+/* Slab header, at the start of each slab's page. */
+struct slab {
+	unsigned magic;             /* Always set to SLAB_MAGIC. */
+	struct kmem_cache *cache;   /* Owning cache. */
+	struct list_elem elem;      /* Element in one of the cache's lists. */
+	void *free;                 /* First free object, or null. */
+	size_t in_use;              /* Objects handed out. */
+};
+
+/* Alignment of objects within a slab. */
+#define SLAB_ALIGN sizeof (void *)
+
+/* Offset of the first object in a slab. */
+#define SLAB_FIRST ROUND_UP (sizeof (struct slab), SLAB_ALIGN)
+
+static struct kmem_cache caches[KMEM_CACHE_MAX];
+static size_t cache_cnt;
+
+static struct slab *slab_create (struct kmem_cache *);
+static struct slab *obj_to_slab (struct kmem_cache *, void *);
+static void **obj_link (struct kmem_cache *, void *);
+
+/* Creates a cache of objects of SIZE bytes named NAME, which
+   must stay valid for the life of the kernel.  If CTOR is not
+   null, it is called on each object when its slab is created.
+   Returns the new cache, or a null pointer if KMEM_CACHE_MAX
+   caches already exist.  Caches are never destroyed. */
+struct kmem_cache *
+kmem_cache_create (const char *name, size_t size, kmem_ctor_func *ctor) {
+	enum intr_level old_level;
+	struct kmem_cache *c;
+
+	ASSERT (name != NULL);
+	ASSERT (size > 0);
+
+	old_level = intr_disable ();
+	c = cache_cnt < KMEM_CACHE_MAX ? &caches[cache_cnt++] : NULL;
+	intr_set_level (old_level);
+	if (c == NULL)
+		return NULL;
+
+	c->name = name;
+	c->size = size;
+	c->stride = ROUND_UP (size, SLAB_ALIGN);
+	c->link_ofs = 0;
+	if (ctor != NULL) {
+		c->link_ofs = c->stride;
+		c->stride += sizeof (void *);
+	}
+	ASSERT (SLAB_FIRST + c->stride <= PGSIZE);
+	c->objs_per_slab = (PGSIZE - SLAB_FIRST) / c->stride;
+	c->ctor = ctor;
+
+	snprintf (c->lock_name, sizeof c->lock_name, "kmem:%s", name);
+	lock_init_named (&c->lock, c->lock_name);
+	list_init (&c->partial);
+	list_init (&c->full);
+	list_init (&c->empty);
+
+	c->allocs = c->frees = 0;
+	c->active = c->peak = c->slabs = 0;
+	return c;
+}
+
+/* Allocates an object from cache C and returns it, or a null
+   pointer if no page is available for a new slab.  The object
+   is uninitialized, or as its constructor left it. */
+void *
+kmem_cache_alloc (struct kmem_cache *c) {
+	struct slab *s;
+	void *obj;
+
+	ASSERT (c != NULL);
+
+	lock_acquire (&c->lock);
+	if (list_empty (&c->partial)) {
+		if (!list_empty (&c->empty))
+			list_push_front (&c->partial, list_pop_front (&c->empty));
+		else {
+			/* Build the slab, constructors and all, without
+			   holding the lock. */
+			lock_release (&c->lock);
+			s = slab_create (c);
+			if (s == NULL)
+				return NULL;
+			lock_acquire (&c->lock);
+			c->slabs++;
+			list_push_front (&c->partial, &s->elem);
+		}
+	}
+
+	s = list_entry (list_front (&c->partial), struct slab, elem);
+	obj = s->free;
+	s->free = *obj_link (c, obj);
+	if (++s->in_use == c->objs_per_slab) {
+		ASSERT (s->free == NULL);
+		list_remove (&s->elem);
+		list_push_front (&c->full, &s->elem);
+	}
+
+	c->allocs++;
+	if (++c->active > c->peak)
+		c->peak = c->active;
+	lock_release (&c->lock);
+	return obj;
+}
+
+/* Allocates a zeroed object from cache C, which must not have a
+   constructor.  Returns a null pointer on failure. */
+void *
+kmem_cache_zalloc (struct kmem_cache *c) {
+	void *obj;
+
+	ASSERT (c->ctor == NULL);
+
+	obj = kmem_cache_alloc (c);
+	if (obj != NULL)
+		memset (obj, 0, c->size);
+	return obj;
+}
+
+/* Returns OBJ, which must have been allocated from cache C, to
+   C.  Does nothing if OBJ is null. */
+void
+kmem_cache_free (struct kmem_cache *c, void *obj) {
+	struct slab *s;
+	struct slab *release = NULL;
+
+	if (obj == NULL)
+		return;
+
+	s = obj_to_slab (c, obj);
+
+#ifndef NDEBUG
+	/* Clear the object to help detect use-after-free bugs.  An
+	   object with a constructor has to keep its state. */
+	if (c->ctor == NULL)
+		memset (obj, 0xcc, c->size);
+#endif
+
+	lock_acquire (&c->lock);
+	ASSERT (s->in_use > 0);
+
+	if (s->in_use == c->objs_per_slab) {
+		list_remove (&s->elem);
+		list_push_front (&c->partial, &s->elem);
+	}
+	*obj_link (c, obj) = s->free;
+	s->free = obj;
+
+	if (--s->in_use == 0) {
+		list_remove (&s->elem);
+		if (list_empty (&c->empty))
+			list_push_front (&c->empty, &s->elem);
+		else {
+			release = s;
+			c->slabs--;
+		}
+	}
+
+	c->frees++;
+	c->active--;
+	lock_release (&c->lock);
+
+	if (release != NULL) {
+		release->magic = 0;
+		palloc_free_page (release);
+	}
+}
+
+/* Prints statistics for every cache that has been used. */
+void
+kmem_cache_print_stats (void) {
+	size_t i;
+
+	for (i = 0; i < cache_cnt; i++) {
+		struct kmem_cache *c = &caches[i];
+
+		if (c->allocs == 0)
+			continue;
+		printf ("Slab %s: %zu B objects (%zu per page), %llu allocs, "
+		        "%llu frees, %zu active (peak %zu), %zu pages\n",
+		        c->name, c->size, c->objs_per_slab, c->allocs, c->frees,
+		        c->active, c->peak, c->slabs);
+	}
+}
+
+/* Obtains a page for cache C, cuts it into objects, runs C's
+   constructor on each and chains them on the new slab's free
+   list.  Returns the slab, or a null pointer if no page is
+   available. */
+static struct slab *
+slab_create (struct kmem_cache *c) {
+	struct slab *s;
+	uint8_t *obj;
+	size_t i;
+
+	s = palloc_get_page (0);
+	if (s == NULL)
+		return NULL;
+
+	s->magic = SLAB_MAGIC;
+	s->cache = c;
+	s->free = NULL;
+	s->in_use = 0;
+
+	/* Chain from the last object back so that allocation goes
+	   through the page in address order. */
+	obj = (uint8_t *) s + SLAB_FIRST + (c->objs_per_slab - 1) * c->stride;
+	for (i = 0; i < c->objs_per_slab; i++, obj -= c->stride) {
+		if (c->ctor != NULL)
+			c->ctor (obj);
+		*obj_link (c, obj) = s->free;
+		s->free = obj;
+	}
+	return s;
+}
+
+/* Returns the slab that OBJ, an object of cache C, is inside. */
+static struct slab *
+obj_to_slab (struct kmem_cache *c, void *obj) {
+	struct slab *s = pg_round_down (obj);
+
+	/* Check that the slab is valid and belongs to C. */
+	ASSERT (s->magic == SLAB_MAGIC);
+	ASSERT (s->cache == c);
+
+	/* Check that the object is properly aligned for the slab. */
+	ASSERT (pg_ofs (obj) >= SLAB_FIRST);
+	ASSERT ((pg_ofs (obj) - SLAB_FIRST) % c->stride == 0);
+
+	return s;
+}
+
+/* Returns the free list link of OBJ in cache C. */
+static void **
+obj_link (struct kmem_cache *c, void *obj) {
+	return (void **) ((uint8_t *) obj + c->link_ofs);
+}
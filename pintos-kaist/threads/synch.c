@@ -31,6 +31,53 @@
 #include <string.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "devices/timer.h"
+
+/* lockstat: lock_init() 호출 위치(파일과 식)별로 묶은 통계.
+   -lockstat일 때만 lock_acquire()/lock_release()가 갱신한다.
+   시간은 timer_ns() 기준 ns. */
+struct lock_class
+{
+	const char *name;			/* "파일:식" */
+	long long acquired;			/* 획득 횟수 */
+	long long contended;		/* 다른 스레드가 잡고 있어 기다린 횟수 */
+	int64_t wait_total;			/* 기다린 시간 합 */
+	int64_t wait_max;			/* 가장 오래 기다린 시간 */
+	int64_t hold_total;			/* 잡고 있던 시간 합 */
+	int64_t hold_max;			/* 가장 오래 잡고 있던 시간 */
+	char max_waiter[16];		/* wait_max 때 기다린 스레드 */
+	char max_holder[16];		/* wait_max 때 잡고 있던 스레드 */
+};
+
+/* 클래스 표. 다 차면 새 이름들은 마지막 칸 "(overflow)"에 모은다. */
+#define LOCK_CLASS_MAX 64
+static struct lock_class lock_classes[LOCK_CLASS_MAX + 1];
+static int lock_class_cnt;
+
+/* 잡혀 있는 락의 획득 시각 (-lockstat의 hold 시간용).
+   struct lock을 키우지 않도록 락 주소로 찾는 열린 주소 해시에 둔다.
+   표가 차면 그 획득의 hold 시간은 재지 않는다. */
+#define LOCK_HELD_MAX 256
+static struct lock_held
+{
+	struct lock *lock;
+	int64_t since;
+} lock_held[LOCK_HELD_MAX];
+
+bool lockstat_enabled;
+
+static struct lock_class *lock_class_of(struct lock *lock);
+static struct lock_class *lock_class_get(const char *name);
+static void lock_held_put(struct lock *lock, int64_t now);
+static bool lock_held_take(struct lock *lock, int64_t *since);
+static bool waiter_less(const struct heap_elem *a, const struct heap_elem *b,
+						void *aux);
+static bool cond_waiter_less(const struct heap_elem *a, const struct heap_elem *b,
+							 void *aux);
+
+/* 대기 순번. 우선순위가 같은 대기자는 먼저 온 순서대로 깨운다. */
+static uint64_t wait_seq;
+static void lock_do_acquire(struct lock *lock);
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -46,7 +93,19 @@ void sema_init(struct semaphore *sema, unsigned value)
 	ASSERT(sema != NULL);
 
 	sema->value = value;
-	list_init(&sema->waiters);
+	heap_init(&sema->waiters, waiter_less, NULL);
+}
+
+/* 세마포어 대기 힙의 순서: 우선순위가 높을수록, 같으면 먼저 온 스레드가 위 */
+static bool
+waiter_less(const struct heap_elem *a, const struct heap_elem *b, void *aux UNUSED)
+{
+	const struct thread *t1 = heap_entry(a, struct thread, wait_elem);
+	const struct thread *t2 = heap_entry(b, struct thread, wait_elem);
+
+	if (t1->priority != t2->priority)
+		return t1->priority > t2->priority;
+	return t1->wait_seq < t2->wait_seq;
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -67,7 +126,18 @@ void sema_down(struct semaphore *sema)
 	old_level = intr_disable();
 	while (sema->value == 0)
 	{
-		list_push_back(&sema->waiters, &thread_current()->elem);
+		struct thread *cur = thread_current();
+
+		/* 기다리는 동안 기부로 우선순위가 바뀌면 thread_change_priority()가
+		   wait_heap에서 자리를 고친다. cond_wait() 중이면 이미 condvar의
+		   힙이 걸려 있고, 이 세마포어에는 자기 혼자뿐이라 그대로 둔다. */
+		cur->wait_seq = wait_seq++;
+		heap_push(&sema->waiters, &cur->wait_elem);
+		if (cur->wait_heap == NULL)
+		{
+			cur->wait_heap = &sema->waiters;
+			cur->wait_helem = &cur->wait_elem;
+		}
 		thread_block();
 	}
 	sema->value--;
@@ -110,12 +180,15 @@ void sema_up(struct semaphore *sema)
 	ASSERT(sema != NULL);
 
 	old_level = intr_disable();
-	if (!list_empty(&sema->waiters))
+	if (!heap_empty(&sema->waiters))
 	{
-		/* 기부로 우선순위가 바뀌었을 수 있으니 재정렬을 수행*/
-		list_sort(&sema->waiters, thread_priority_greater, NULL);
-		thread_unblock(list_entry(list_pop_front(&sema->waiters),
-								  struct thread, elem));
+		/* 힙 맨 위가 가장 높은 우선순위: 정렬 없이 O(log n) */
+		struct thread *t = heap_entry(heap_pop(&sema->waiters),
+									  struct thread, wait_elem);
+
+		if (t->wait_heap == &sema->waiters)
+			t->wait_heap = NULL;
+		thread_unblock(t);
 	}
 	sema->value++;
 	intr_set_level(old_level);
@@ -175,12 +248,102 @@ sema_test_helper(void *sema_)
    acquire and release it.  When these restrictions prove
    onerous, it's a good sign that a semaphore should be used,
    instead of a lock. */
-void lock_init(struct lock *lock)
+void lock_init_named(struct lock *lock, const char *class_name)
 {
 	ASSERT(lock != NULL);
 
 	lock->holder = NULL;
 	sema_init(&lock->semaphore, 1);
+	lock->stat.name = class_name; /* 클래스는 -lockstat이 처음 쓸 때 찾는다 */
+}
+
+/* LOCK의 클래스. 아직 이름만 있으면 찾아서 그 자리에 기록한다.
+   인터럽트가 꺼진 상태에서 호출해야 한다. */
+static struct lock_class *
+lock_class_of(struct lock *lock)
+{
+	uintptr_t p = (uintptr_t)lock->stat.class;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (p >= (uintptr_t)lock_classes && p < (uintptr_t)(lock_classes + LOCK_CLASS_MAX + 1))
+		return lock->stat.class;
+	return lock->stat.class = lock_class_get(lock->stat.name);
+}
+
+/* NAME 클래스를 찾고, 없으면 만든다. 표가 차면 "(overflow)" 칸을 준다.
+   인터럽트가 꺼진 상태에서 호출해야 한다. */
+static struct lock_class *
+lock_class_get(const char *name)
+{
+	struct lock_class *class;
+
+	for (int i = 0; i < lock_class_cnt; i++)
+		if (!strcmp(lock_classes[i].name, name))
+			return &lock_classes[i];
+
+	if (lock_class_cnt == LOCK_CLASS_MAX)
+	{
+		class = &lock_classes[LOCK_CLASS_MAX];
+		class->name = "(overflow)";
+		return class;
+	}
+	class = &lock_classes[lock_class_cnt++];
+	class->name = name;
+	return class;
+}
+
+/* LOCK을 NOW에 잡았다고 기록한다. 인터럽트가 꺼진 상태에서 호출. */
+static void
+lock_held_put(struct lock *lock, int64_t now)
+{
+	size_t h = ((uintptr_t)lock >> 3) % LOCK_HELD_MAX;
+
+	for (size_t i = 0; i < LOCK_HELD_MAX; i++, h = (h + 1) % LOCK_HELD_MAX)
+		if (lock_held[h].lock == NULL)
+		{
+			lock_held[h].lock = lock;
+			lock_held[h].since = now;
+			return;
+		}
+}
+
+/* LOCK을 잡은 시각을 *SINCE에 꺼내고 기록을 지운다. 기록이 없으면
+   false. 인터럽트가 꺼진 상태에서 호출. */
+static bool
+lock_held_take(struct lock *lock, int64_t *since)
+{
+	size_t h = ((uintptr_t)lock >> 3) % LOCK_HELD_MAX;
+	size_t i;
+
+	for (i = 0; i < LOCK_HELD_MAX; i++, h = (h + 1) % LOCK_HELD_MAX)
+	{
+		if (lock_held[h].lock == NULL)
+			return false;
+		if (lock_held[h].lock == lock)
+			break;
+	}
+	if (i == LOCK_HELD_MAX)
+		return false;
+	*since = lock_held[h].since;
+
+	/* 뒤따르는 항목들을 당겨 탐색 사슬이 끊기지 않게 한다 */
+	for (size_t j = (h + 1) % LOCK_HELD_MAX;; j = (j + 1) % LOCK_HELD_MAX)
+	{
+		size_t home;
+
+		if (lock_held[j].lock == NULL)
+			break;
+		home = ((uintptr_t)lock_held[j].lock >> 3) % LOCK_HELD_MAX;
+		/* HOME이 (H, J] 밖이면 J의 항목을 빈 칸 H로 옮길 수 있다 */
+		if ((j > h && (home <= h || home > j)) || (j < h && home <= h && home > j))
+		{
+			lock_held[h] = lock_held[j];
+			h = j;
+		}
+	}
+	lock_held[h].lock = NULL;
+	return true;
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -192,6 +355,51 @@ void lock_init(struct lock *lock)
    interrupts disabled, but interrupts will be turned back on if
    we need to sleep. */
 void lock_acquire(struct lock *lock)
+{
+	struct lock_class *class;
+	struct thread *holder;
+	char holder_name[16];
+	enum intr_level old_level;
+	int64_t start, now;
+
+	if (!lockstat_enabled)
+	{
+		lock_do_acquire(lock);
+		return;
+	}
+
+	/* lockstat: 기다린 시간과, 기다렸다면 누가 잡고 있었는지 기록 */
+	old_level = intr_disable();
+	class = lock_class_of(lock);
+	holder = lock->holder;
+	if (holder != NULL)
+		strlcpy(holder_name, holder->name, sizeof holder_name);
+	intr_set_level(old_level);
+
+	start = timer_ns();
+	lock_do_acquire(lock);
+	now = timer_ns();
+
+	old_level = intr_disable();
+	class->acquired++;
+	if (holder != NULL)
+	{
+		class->contended++;
+		class->wait_total += now - start;
+		if (now - start > class->wait_max)
+		{
+			class->wait_max = now - start;
+			strlcpy(class->max_waiter, thread_name(), sizeof class->max_waiter);
+			strlcpy(class->max_holder, holder_name, sizeof class->max_holder);
+		}
+	}
+	lock_held_put(lock, now);
+	intr_set_level(old_level);
+}
+
+/* lock_acquire()의 본체 (우선순위 기부 포함). */
+static void
+lock_do_acquire(struct lock *lock)
 {
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
@@ -236,7 +444,17 @@ bool lock_try_acquire(struct lock *lock)
 
 	success = sema_try_down(&lock->semaphore);
 	if (success)
+	{
 		lock->holder = thread_current();
+		if (lockstat_enabled)
+		{
+			enum intr_level old_level = intr_disable();
+
+			lock_class_of(lock)->acquired++;
+			lock_held_put(lock, timer_ns());
+			intr_set_level(old_level);
+		}
+	}
 	return success;
 }
 
@@ -255,6 +473,23 @@ void lock_release(struct lock *lock)
 	ASSERT(lock != NULL);
 	ASSERT(lock_held_by_current_thread(lock));
 
+	if (lockstat_enabled)
+	{
+		enum intr_level old_level = intr_disable();
+		struct lock_class *class = lock_class_of(lock);
+		int64_t since;
+
+		if (lock_held_take(lock, &since))
+		{
+			int64_t hold = timer_ns() - since;
+
+			class->hold_total += hold;
+			if (hold > class->hold_max)
+				class->hold_max = hold;
+		}
+		intr_set_level(old_level);
+	}
+
 	lock->holder = NULL;
 	if (thread_mlfqs)
 	{
@@ -264,8 +499,6 @@ void lock_release(struct lock *lock)
 
 	struct thread *cur = thread_current();
 
-	lock->holder = NULL;
-
 	/* lock_release()에서 lock과 관련된 기부자들을 제거하는 함수*/
 	thread_remove_donations_for_lock(lock);
 
@@ -286,11 +519,13 @@ bool lock_held_by_current_thread(const struct lock *lock)
 	return lock->holder == thread_current();
 }
 
-/* One semaphore in a list. */
+/* One semaphore in a condition variable's waiter heap. */
 struct semaphore_elem
 {
-	struct list_elem elem;		/* List element. */
+	struct heap_elem elem;		/* Heap element. */
 	struct semaphore semaphore; /* This semaphore. */
+	struct thread *thread;		/* 기다리는 스레드 */
+	uint64_t seq;				/* 대기 순번 */
 };
 
 /* Initializes condition variable COND.  A condition variable
@@ -300,7 +535,20 @@ void cond_init(struct condition *cond)
 {
 	ASSERT(cond != NULL);
 
-	list_init(&cond->waiters);
+	heap_init(&cond->waiters, cond_waiter_less, NULL);
+}
+
+/* condvar 대기 힙의 순서: 기다리는 스레드의 우선순위가 높을수록,
+   같으면 먼저 온 쪽이 위 */
+static bool
+cond_waiter_less(const struct heap_elem *a, const struct heap_elem *b, void *aux UNUSED)
+{
+	const struct semaphore_elem *w1 = heap_entry(a, struct semaphore_elem, elem);
+	const struct semaphore_elem *w2 = heap_entry(b, struct semaphore_elem, elem);
+
+	if (w1->thread->priority != w2->thread->priority)
+		return w1->thread->priority > w2->thread->priority;
+	return w1->seq < w2->seq;
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -326,6 +574,8 @@ void cond_init(struct condition *cond)
 void cond_wait(struct condition *cond, struct lock *lock)
 {
 	struct semaphore_elem waiter;
+	struct thread *cur = thread_current();
+	enum intr_level old_level;
 
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
@@ -333,23 +583,22 @@ void cond_wait(struct condition *cond, struct lock *lock)
 	ASSERT(lock_held_by_current_thread(lock));
 
 	sema_init(&waiter.semaphore, 0);
-	list_push_back(&cond->waiters, &waiter.elem);
+	waiter.thread = cur;
+
+	/* 기부에 의한 자리 고침(thread_change_priority)은 인터럽트를 끄고
+	   힙을 건드리므로 여기서도 인터럽트를 끈다. */
+	old_level = intr_disable();
+	waiter.seq = wait_seq++;
+	heap_push(&cond->waiters, &waiter.elem);
+	cur->wait_heap = &cond->waiters;
+	cur->wait_helem = &waiter.elem;
+	intr_set_level(old_level);
 
 	lock_release(lock);
 	sema_down(&waiter.semaphore);
 	lock_acquire(lock);
 }
 
-/* condvar 에서 semaphor_elem 내림차순 정렬을 위한 함수 */
-bool semaphore_priority_greater(const struct list_elem *a,
-								const struct list_elem *b, void *aux)
-{
-	const struct semaphore_elem *t1 = list_entry(a, struct semaphore_elem, elem);
-	const struct semaphore_elem *t2 = list_entry(b, struct semaphore_elem, elem);
-
-	return list_entry(t1->semaphore.waiters.head.next, struct thread, elem)->priority > list_entry(t2->semaphore.waiters.head.next, struct thread, elem)->priority;
-}
-
 /* If any threads are waiting on COND (protected by LOCK), then
    this function signals one of them to wake up from its wait.
    LOCK must be held before calling this function.
@@ -359,19 +608,26 @@ bool semaphore_priority_greater(const struct list_elem *a,
    interrupt handler. */
 void cond_signal(struct condition *cond, struct lock *lock UNUSED)
 {
+	struct semaphore_elem *waiter = NULL;
+	enum intr_level old_level;
+
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
-	if (!list_empty(&cond->waiters))
+	old_level = intr_disable();
+	if (!heap_empty(&cond->waiters))
 	{
-		/* waiter_list에서 pop을 하기 전에 sort*/
-		list_sort(&cond->waiters, semaphore_priority_greater, NULL);
-		sema_up(&list_entry(list_pop_front(&cond->waiters),
-							struct semaphore_elem, elem)
-					 ->semaphore);
+		/* 힙 맨 위가 가장 높은 우선순위의 대기자 */
+		waiter = heap_entry(heap_pop(&cond->waiters), struct semaphore_elem, elem);
+		if (waiter->thread->wait_heap == &cond->waiters)
+			waiter->thread->wait_heap = NULL;
 	}
+	intr_set_level(old_level);
+
+	if (waiter != NULL)
+		sema_up(&waiter->semaphore);
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -385,6 +641,238 @@ void cond_broadcast(struct condition *cond, struct lock *lock)
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 
-	while (!list_empty(&cond->waiters))
+	while (!heap_empty(&cond->waiters))
 		cond_signal(cond, lock);
 }
+
+/* Initializes spinlock LOCK. */
+void spin_lock_init(struct spinlock *lock)
+{
+	ASSERT(lock != NULL);
+
+	lock->locked = 0;
+}
+
+/* 인터럽트를 끄고 LOCK을 잡는다. 잡는 동안 잠들면 안 된다.
+   CPU가 하나뿐이므로 이미 잡혀 있다면 같은 CPU에서 다시 잡으려는 것이고,
+   기다려도 풀리지 않는다. */
+void spin_lock(struct spinlock *lock)
+{
+	enum intr_level old_level;
+
+	ASSERT(lock != NULL);
+
+	old_level = intr_disable();
+	ASSERT(!lock->locked);
+	lock->locked = 1;
+	lock->old_level = old_level;
+}
+
+/* LOCK을 풀고 spin_lock() 이전의 인터럽트 상태로 돌아간다. */
+void spin_unlock(struct spinlock *lock)
+{
+	enum intr_level old_level;
+
+	ASSERT(lock != NULL && lock->locked);
+
+	old_level = lock->old_level;
+	lock->locked = 0;
+	intr_set_level(old_level);
+}
+
+/* Initializes reader-writer lock RW.  Its writer lock is
+   counted under CLASS_NAME by -lockstat. */
+void rw_init_named(struct rwlock *rw, const char *class_name)
+{
+	ASSERT(rw != NULL);
+
+	lock_init_named(&rw->wlock, class_name);
+	spin_lock_init(&rw->guard);
+	rw->readers = 0;
+	rw->writers = 0;
+	rw->draining = false;
+	sema_init(&rw->drained, 0);
+}
+
+/* RW을 읽기용으로 잡는다.
+   기다리는 writer가 없으면 카운터만 올리고 끝난다(fast path).
+   있으면 writer가 잡은 wlock 뒤에 줄을 서서 (우선순위를 기부하며)
+   writer가 끝나기를 기다린다. 잠들 수 있으므로 인터럽트 핸들러에서는
+   부를 수 없다. */
+void rw_read_acquire(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+
+	spin_lock(&rw->guard);
+	if (rw->writers == 0)
+	{
+		rw->readers++;
+		spin_unlock(&rw->guard);
+		return;
+	}
+	spin_unlock(&rw->guard);
+
+	/* wlock을 잡았다는 것은 앞선 writer가 모두 끝났다는 뜻 */
+	lock_acquire(&rw->wlock);
+	spin_lock(&rw->guard);
+	rw->readers++;
+	spin_unlock(&rw->guard);
+	lock_release(&rw->wlock);
+}
+
+/* RW의 읽기 잠금을 푼다. 마지막 reader면 기다리는 writer를 깨운다. */
+void rw_read_release(struct rwlock *rw)
+{
+	bool wake;
+
+	ASSERT(rw != NULL);
+
+	spin_lock(&rw->guard);
+	ASSERT(rw->readers > 0);
+	rw->readers--;
+	wake = rw->readers == 0 && rw->draining;
+	if (wake)
+		rw->draining = false;
+	spin_unlock(&rw->guard);
+
+	/* sema_up()은 선점으로 양보할 수 있으므로 spinlock 밖에서 */
+	if (wake)
+		sema_up(&rw->drained);
+}
+
+/* RW를 쓰기용으로 잡는다. 먼저 writers를 올려 새 reader를 막고,
+   wlock으로 다른 writer를 배제한 뒤, 이미 들어와 있던 reader들이
+   모두 나갈 때까지 기다린다.
+   drained를 기다리는 동안에는 reader들에게 기부하지 않는다. 기부는
+   스레드마다 donation_elem 하나로 한 holder에게만 걸 수 있어서 여러
+   reader에게 나눠 걸 수 없고, reader는 누구인지 기록하지 않고 수만 센다.
+   그래서 읽기 구간은 짧아야 하고 그 안에서 잠들면 안 된다. */
+void rw_write_acquire(struct rwlock *rw)
+{
+	bool wait;
+
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+
+	spin_lock(&rw->guard);
+	rw->writers++;
+	spin_unlock(&rw->guard);
+
+	lock_acquire(&rw->wlock);
+
+	spin_lock(&rw->guard);
+	wait = rw->readers > 0;
+	rw->draining = wait;
+	spin_unlock(&rw->guard);
+	if (wait)
+		sema_down(&rw->drained);
+}
+
+/* RW의 쓰기 잠금을 푼다. 기다리던 reader와 writer는 wlock 순서대로 들어온다. */
+void rw_write_release(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+	ASSERT(lock_held_by_current_thread(&rw->wlock));
+
+	spin_lock(&rw->guard);
+	rw->writers--;
+	spin_unlock(&rw->guard);
+
+	lock_release(&rw->wlock);
+}
+
+/* Initializes sequence lock SL. */
+void seq_init(struct seqlock *sl)
+{
+	ASSERT(sl != NULL);
+
+	sl->seq = 0;
+	spin_lock_init(&sl->lock);
+}
+
+/* 읽기를 시작한다. 쓰기 중(홀수)이면 끝날 때까지 돌고, 시작 시점의
+   순번을 반환한다. 인터럽트 핸들러에서도 부를 수 있다. */
+unsigned seq_read_begin(const struct seqlock *sl)
+{
+	unsigned seq;
+
+	while ((seq = __atomic_load_n(&sl->seq, __ATOMIC_ACQUIRE)) & 1)
+		asm volatile("pause");
+	return seq;
+}
+
+/* seq_read_begin()이 START를 반환한 뒤로 쓰기가 있었으면 true:
+   읽은 값을 버리고 다시 읽어야 한다. */
+bool seq_read_retry(const struct seqlock *sl, unsigned start)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return sl->seq != start;
+}
+
+/* 쓰기를 시작한다. 다른 writer와 이 CPU의 인터럽트를 막고 순번을
+   홀수로 만든다. seq_write_end()까지 잠들면 안 된다. */
+void seq_write_begin(struct seqlock *sl)
+{
+	spin_lock(&sl->lock);
+	sl->seq++;
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/* 쓰기를 끝낸다. 순번을 다시 짝수로 만든다. */
+void seq_write_end(struct seqlock *sl)
+{
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	sl->seq++;
+	spin_unlock(&sl->lock);
+}
+
+/* lockstat 결과를 기다린 시간 합이 큰 클래스부터 출력한다.
+   이름은 "파일:식"에서 경로와 &를 뗀 것. 시간은 us. */
+void lockstat_print(void)
+{
+	struct lock_class *sorted[LOCK_CLASS_MAX + 1];
+	int cnt = 0;
+
+	if (!lockstat_enabled)
+		return;
+
+	/* 쓰지 않은 칸은 acquired가 0이라 건너뛴다 */
+	for (int i = 0; i < LOCK_CLASS_MAX + 1; i++)
+	{
+		struct lock_class *class = &lock_classes[i];
+		int j;
+
+		if (class->acquired == 0)
+			continue;
+		for (j = cnt; j > 0 && sorted[j - 1]->wait_total < class->wait_total; j--)
+			sorted[j] = sorted[j - 1];
+		sorted[j] = class;
+		cnt++;
+	}
+
+	printf("Lockstat: %-28s %9s %9s %10s %8s %10s %8s  %s\n", "class", "acq", "contend",
+		   "wait(us)", "max", "hold(us)", "max", "max waiter <- holder");
+	for (int i = 0; i < cnt; i++)
+	{
+		struct lock_class *class = sorted[i];
+		const char *name = strrchr(class->name, '/');
+		char label[29];
+		const char *colon;
+
+		/* "../../vm/vm.c:&frame_table_lock" -> "vm.c:frame_table_lock" */
+		name = name != NULL ? name + 1 : class->name;
+		colon = strchr(name, ':');
+		if (colon != NULL && colon[1] == '&')
+			snprintf(label, sizeof label, "%.*s:%s", (int)(colon - name), name, colon + 2);
+		else
+			strlcpy(label, name, sizeof label);
+
+		printf("Lockstat: %-28s %9lld %9lld %10lld %8lld %10lld %8lld  %s <- %s\n", label,
+			   class->acquired, class->contended,
+			   (long long)class->wait_total / 1000, (long long)class->wait_max / 1000,
+			   (long long)class->hold_total / 1000, (long long)class->hold_max / 1000,
+			   class->contended ? class->max_waiter : "-",
+			   class->contended ? class->max_holder : "-");
+	}
+}
@@ -2,12 +2,15 @@
 #include <debug.h>
 #include <stddef.h>
 #include <random.h>
+#include <round.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
+#include "threads/switch.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
 #include "threads/fixed_point.h"
@@ -27,16 +30,28 @@
    Do not modify this value. */
 #define THREAD_BASIC 0xd42df210
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
+/* Processes in THREAD_READY state, that is, processes that are
+   ready to run but not actually running, kept in one FIFO queue
+   per priority.  Bit P of ready_mask is set iff ready_queues[P]
+   is nonempty, so the highest ready priority is a single bsr. */
+static struct list ready_queues[PRI_MAX + 1];
+static uint64_t ready_mask;
+static int ready_cnt; /* 모든 ready 큐에 있는 스레드 수 */
 
-/* 모든 스레드의 리스트 */
-static struct list all_list;
+/* 실시간(EDF) 클래스의 ready 스레드, 마감 시각 순.
+   다른 모든 클래스보다 먼저 실행된다. */
+static struct list rt_queue;
+
+/* -stride: ready 스레드는 우선순위 큐 대신 pass 순 힙에 들어간다. */
+static struct thread *stride_heap; /* pass가 가장 작은 스레드가 루트 */
+static int64_t stride_pass;		   /* 마지막으로 고른 스레드의 pass (가상 시간) */
 
 /* Idle thread. */
 static struct thread *idle_thread;
 
+/* 모든 스레드의 리스트 */
+static struct list all_list;
+
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
 
@@ -46,23 +61,69 @@ static struct lock tid_lock;
 /* Thread destruction requests */
 static struct list destruction_req;
 
+/* 최근 해제된 스레드 페이지 캐시 (LIFO).
+   fork/exit가 잦을 때 palloc의 락, 비트맵 탐색, 페이지 0 채우기를
+   피한다. 스레드 페이지는 init_thread()가 struct thread만 초기화하면
+   된다. 인터럽트를 끈 상태에서 접근한다. */
+#define THREAD_CACHE_MAX 16
+static void *thread_page_cache[THREAD_CACHE_MAX];
+static int thread_page_cnt;
+
 /* Statistics. */
 static long long idle_ticks;   /* # of timer ticks spent idle. */
 static long long kernel_ticks; /* # of timer ticks in kernel threads. */
 static long long user_ticks;   /* # of timer ticks in user programs. */
+static long long create_cnt;	/* # of thread_create() calls. */
+static long long create_cycles; /* TSC cycles spent in thread_create(). */
+static long long cache_hits;	/* # of pages taken from the thread cache. */
 
 /* Scheduling. */
 #define TIME_SLICE 4		  /* # of timer ticks to give each thread. */
 static unsigned thread_ticks; /* # of timer ticks since last yield. */
 
+/* 스케줄링 지연 히스토그램 (우선순위별, us 단위 log2 구간).
+   구간 0은 1us 미만, 구간 i는 [2^(i-1), 2^i) us, 마지막 구간은 그 이상.
+   wake_hist : thread_unblock부터 CPU를 받기까지 걸린 시간
+   slice_hist : CPU를 받고 내놓기까지 실제로 실행한 시간
+   preempt_cnt : thread_preempt()가 선점시킨 횟수 (선점당한 쪽 우선순위)
+   schedule()에서 인터럽트를 끈 채로 갱신한다. */
+#define LAT_BUCKETS 20
+static unsigned wake_hist[PRI_MAX + 1][LAT_BUCKETS];
+static unsigned slice_hist[PRI_MAX + 1][LAT_BUCKETS];
+static unsigned preempt_cnt[PRI_MAX + 1];
+
 /* If false (default), use round-robin scheduler.
    If true, use multi-level feedback queue scheduler.
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* If true, use the stride (proportional-share) scheduler:
+   each thread gets CPU time in proportion to its tickets.
+   Controlled by kernel command-line option "-stride". */
+bool thread_stride;
+
+/* stride = STRIDE1 / tickets. 한 틱 실행할 때마다 pass가 stride만큼
+   늘고, 항상 pass가 가장 작은 스레드가 다음으로 실행된다. */
+#define STRIDE1 (1 << 20)
+
+/* 실시간 클래스 스레드들의 예약 CPU 비율 합 (천분율).
+   RT_UTIL_MAX를 넘는 예약은 거절해 일반 스레드 몫을 남긴다. */
+#define RT_UTIL_MAX 900
+static int rt_util_total;
+
 /* mlfq를 위한 load_avg 전역변수 선언*/
 int load_avg;
 
+/* recent_cpu 감쇠가 적용된 횟수(초). 스레드마다 자신의 mlfqs_epoch까지
+   감쇠가 적용되어 있다. decay_coeff[e % DECAY_HISTORY]는 e번째 감쇠의
+   계수 2*load_avg / (2*load_avg + 1)이다. */
+#define DECAY_HISTORY 64
+static unsigned mlfqs_epoch;
+static int decay_coeff[DECAY_HISTORY];
+
+/* 다음 4틱 재계산 때 priority를 다시 계산할 스레드들 */
+static struct list mlfqs_dirty_list;
+
 static void kernel_thread(thread_func *, void *aux);
 
 static void idle(void *aux UNUSED);
@@ -71,6 +132,17 @@ static void init_thread(struct thread *, const char *name, int priority);
 static void do_schedule(int status);
 static void schedule(void);
 static tid_t allocate_tid(void);
+static void ready_push(struct thread *t);
+static void ready_remove(struct thread *t);
+static int ready_max_priority(void);
+static struct thread *ready_pop(void);
+static struct thread *stride_merge(struct thread *a, struct thread *b);
+static bool rt_should_preempt(void);
+static void rt_replenish(struct timer_event *ev);
+static void thread_change_priority(struct thread *t, int priority);
+static void preempt_current(void);
+static void lat_record(unsigned hist[][LAT_BUCKETS], int priority, int64_t ns);
+static void lat_print(const char *what, unsigned hist[][LAT_BUCKETS]);
 
 /* Returns true if T appears to point to a valid thread. */
 #define is_thread(t) ((t) != NULL && (t)->magic == THREAD_MAGIC)
@@ -114,11 +186,16 @@ void thread_init(void)
 
 	/* Init the globla thread context */
 	lock_init(&tid_lock);
-	list_init(&ready_list);
+	for (int pri = PRI_MIN; pri <= PRI_MAX; pri++)
+		list_init(&ready_queues[pri]);
+	ready_mask = 0;
+	ready_cnt = 0;
+	list_init(&rt_queue);
 	list_init(&destruction_req);
 
 	/* all_list 초기화 추가*/
 	list_init(&all_list);
+	list_init(&mlfqs_dirty_list);
 	console_file_init(); // 콘솔 가짜파일 초기화
 
 	/* Set up a thread structure for the running thread. */
@@ -148,8 +225,9 @@ void thread_start(void)
 }
 
 /* Called by the timer interrupt handler at each timer tick.
-   Thus, this function runs in an external interrupt context. */
-void thread_tick(void)
+   Thus, this function runs in an external interrupt context.
+   USER is true if the tick interrupted user mode. */
+void thread_tick(bool user)
 {
 	struct thread *t = thread_current();
 
@@ -163,6 +241,45 @@ void thread_tick(void)
 	else
 		kernel_ticks++;
 
+	/* 스레드별 CPU 시간: 틱이 유저 모드를 끊었는지로 나눈다 */
+	if (user)
+		t->rusage.utime++;
+	else
+		t->rusage.stime++;
+
+	/* stride: 실행한 틱만큼 pass를 올린다 */
+	if (thread_stride && t != idle_thread)
+		t->pass += t->stride;
+
+	/* 실시간 스레드는 time slice 대신 예산으로 제한한다.
+	   마감을 넘기면 놓친 것으로 세고 다음 주기를 시작하고,
+	   예산을 다 쓰면 마감 시각까지 쉬게 한다(throttle). */
+	if (t->rt_period != 0)
+	{
+		int64_t now = timer_ticks();
+
+		/* 이미 throttle 되어 양보를 기다리는 중이다. one-shot 모드에서
+		   clock_event()가 놓친 틱을 몰아서 부르면 여기로 다시 오는데,
+		   rt_event가 이미 걸려 있으므로 다시 걸면 안 된다. */
+		if (t->rt_throttled)
+			return;
+
+		t->rt_left--;
+		if (now >= t->rt_deadline)
+		{
+			t->rt_misses++;
+			t->rt_deadline = now + t->rt_period;
+			t->rt_left = t->rt_budget;
+		}
+		else if (t->rt_left <= 0)
+		{
+			t->rt_throttled = true;
+			timer_event_add(&t->rt_event, t->rt_deadline);
+			intr_yield_on_return();
+		}
+		return;
+	}
+
 	/* Enforce preemption. */
 	if (++thread_ticks >= TIME_SLICE)
 		intr_yield_on_return();
@@ -173,6 +290,188 @@ void thread_print_stats(void)
 {
 	printf("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
 		   idle_ticks, kernel_ticks, user_ticks);
+	if (create_cnt > 0)
+		printf("Thread: %lld creates, %lld cycles avg, %lld pages from cache\n",
+			   create_cnt, create_cycles / create_cnt, cache_hits);
+
+	lat_print("wake", wake_hist);
+	lat_print("slice", slice_hist);
+	for (int pri = PRI_MAX; pri >= PRI_MIN; pri--)
+		if (preempt_cnt[pri] != 0)
+			printf("Sched: preempt pri %d: %u\n", pri, preempt_cnt[pri]);
+}
+
+/* HIST의 PRIORITY 줄에서 NS 나노초가 속한 구간을 하나 올린다. */
+static void
+lat_record(unsigned hist[][LAT_BUCKETS], int priority, int64_t ns)
+{
+	int64_t us = ns / 1000;
+	int bucket = us <= 0 ? 0 : 64 - __builtin_clzll(us);
+
+	if (bucket >= LAT_BUCKETS)
+		bucket = LAT_BUCKETS - 1;
+	hist[priority][bucket]++;
+}
+
+/* 표본이 있는 우선순위마다 HIST를 한 줄씩 출력한다.
+   각 항목은 "구간 상한:횟수", 마지막 구간은 "+"로 표시한다. */
+static void
+lat_print(const char *what, unsigned hist[][LAT_BUCKETS])
+{
+	for (int pri = PRI_MAX; pri >= PRI_MIN; pri--)
+	{
+		unsigned total = 0;
+
+		for (int b = 0; b < LAT_BUCKETS; b++)
+			total += hist[pri][b];
+		if (total == 0)
+			continue;
+
+		printf("Sched: %s pri %d: n=%u", what, pri, total);
+		for (int b = 0; b < LAT_BUCKETS; b++)
+			if (hist[pri][b] != 0)
+				printf(b < LAT_BUCKETS - 1 ? " <%dus:%u" : " %dus+:%u",
+					   b < LAT_BUCKETS - 1 ? 1 << b : 1 << (b - 1), hist[pri][b]);
+		printf("\n");
+	}
+}
+
+/* CACHE 스택에서 페이지 하나를 꺼낸다. 비었으면 NULL. */
+static void *
+cache_pop(void **cache, int *cnt)
+{
+	enum intr_level old_level = intr_disable();
+	void *page = *cnt > 0 ? cache[--*cnt] : NULL;
+
+	intr_set_level(old_level);
+	if (page != NULL)
+		cache_hits++;
+	return page;
+}
+
+/* PAGE를 CACHE 스택에 넣는다. 가득 찼으면 palloc에 돌려준다. */
+static void
+cache_push(void **cache, int *cnt, void *page)
+{
+	enum intr_level old_level = intr_disable();
+
+	if (*cnt < THREAD_CACHE_MAX)
+	{
+		cache[(*cnt)++] = page;
+		page = NULL;
+	}
+	intr_set_level(old_level);
+	if (page != NULL)
+		palloc_free_page(page);
+}
+
+/* 스레드 페이지 할당. struct thread는 init_thread()가 초기화하고
+   스택 영역은 0일 필요가 없으므로 페이지를 0으로 채우지 않는다. */
+static struct thread *
+thread_page_alloc(void)
+{
+	struct thread *t = cache_pop(thread_page_cache, &thread_page_cnt);
+
+	return t != NULL ? t : palloc_get_page(0);
+}
+
+/* fd CAP칸을 덮는 사용 중 비트맵의 워드 수 */
+static int
+fd_used_words(int cap)
+{
+	return DIV_ROUND_UP(cap, 64);
+}
+
+/* T의 FD에 열린 파일, 없으면 NULL. */
+struct file *
+thread_fd_get(struct thread *t, int fd)
+{
+	if (fd < 0 || fd >= t->fd_cap)
+		return NULL;
+	return t->fd_table[fd];
+}
+
+/* T의 FD 칸에 F를 넣는다(NULL이면 비운다). 필요하면 테이블을 두 배씩
+   늘린다. FD가 범위를 벗어나거나 메모리가 없으면 false.
+   테이블을 늘릴 수 있으므로 T의 스레드 문맥에서 호출해야 한다. */
+bool thread_fd_set(struct thread *t, int fd, struct file *f)
+{
+	if (fd < 0 || fd >= MAX_FD)
+		return false;
+
+	if (fd >= t->fd_cap)
+	{
+		struct file **table;
+		uint64_t *used;
+		int cap = t->fd_cap;
+
+		if (f == NULL)
+			return true;
+		while (cap <= fd)
+			cap *= 2;
+		if (cap > MAX_FD)
+			cap = MAX_FD;
+
+		/* 비트맵은 새 테이블 바로 뒤에 함께 할당한다 */
+		table = calloc(1, cap * sizeof *table + fd_used_words(cap) * sizeof *used);
+		if (table == NULL)
+			return false;
+		used = (uint64_t *)(table + cap);
+		memcpy(table, t->fd_table, t->fd_cap * sizeof *table);
+		memcpy(used, t->fd_used, fd_used_words(t->fd_cap) * sizeof *used);
+		if (t->fd_table != t->fd_inline)
+			free(t->fd_table);
+		t->fd_table = table;
+		t->fd_used = used;
+		t->fd_cap = cap;
+	}
+
+	t->fd_table[fd] = f;
+	if (f != NULL)
+	{
+		t->fd_used[fd / 64] |= 1ULL << (fd % 64);
+		if (fd >= t->fd_end)
+			t->fd_end = fd + 1;
+	}
+	else
+	{
+		t->fd_used[fd / 64] &= ~(1ULL << (fd % 64));
+		/* 마지막 fd를 닫았으면 사용 중인 가장 큰 fd로 줄인다 */
+		while (t->fd_end > 0)
+		{
+			int w = (t->fd_end - 1) / 64;
+			uint64_t bits = t->fd_used[w] & (~0ULL >> (63 - (t->fd_end - 1) % 64));
+
+			if (bits != 0)
+			{
+				t->fd_end = w * 64 + 64 - __builtin_clzll(bits);
+				break;
+			}
+			t->fd_end = w * 64;
+		}
+	}
+	return true;
+}
+
+/* T의 가장 작은 빈 fd에 F를 넣고 그 fd를 반환한다. 없으면 -1.
+   사용 중 비트맵을 64칸씩 보며 tzcnt로 찾고, 다 차 있으면 테이블
+   끝 다음 칸을 쓴다 (thread_fd_set이 테이블을 늘린다). */
+int thread_fd_alloc(struct thread *t, struct file *f)
+{
+	int words = fd_used_words(t->fd_cap);
+	int fd = words * 64;
+
+	for (int w = 0; w < words; w++)
+	{
+		uint64_t free_bits = ~t->fd_used[w];
+
+		if (free_bits != 0)
+		{
+			fd = w * 64 + __builtin_ctzll(free_bits);
+			break;
+		}
+	}
+	return thread_fd_set(t, fd, f) ? fd : -1;
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -195,11 +494,14 @@ tid_t thread_create(const char *name, int priority,
 {
 	struct thread *t;
 	tid_t tid;
+	struct switch_frame *sf;
 
 	ASSERT(function != NULL);
 
+	uint64_t start = rdtsc();
+
 	/* Allocate thread. */
-	t = palloc_get_page(PAL_ZERO);
+	t = thread_page_alloc();
 	if (t == NULL)
 		return TID_ERROR;
 
@@ -207,29 +509,23 @@ tid_t thread_create(const char *name, int priority,
 	init_thread(t, name, priority);
 	tid = t->tid = allocate_tid();
 
-	/* fd 테이블을 동적 페이지로 할당 */
-	t->fd_table = palloc_get_page(PAL_ZERO);
-	if (t->fd_table == NULL)
-	{
-		/* palloc 실패 시, 구조체 페이지도 돌려주고 에러 처리 */
-		palloc_free_page(t);
-		return TID_ERROR;
-	}
-	/* fd 테이블은 palloc_zero된 페이지라 이미 NULL로 초기화됨 */
-	t->fd_table[0] = &console_in;
-	t->fd_table[1] = &console_out;
-	t->next_fd = 2; /* 0: stdin, 1: stdout 예약 */
+	/* fd 테이블은 struct thread 안의 작은 배열에서 시작한다 */
+	thread_fd_set(t, 0, &console_in);
+	thread_fd_set(t, 1, &console_out);
 
 	/* Call the kernel_thread if it scheduled.
-	 * Note) rdi is 1st argument, and rsi is 2nd argument. */
-	t->tf.rip = (uintptr_t)kernel_thread;
-	t->tf.R.rdi = (uint64_t)function;
-	t->tf.R.rsi = (uint64_t)aux;
-	t->tf.ds = SEL_KDSEG;
-	t->tf.es = SEL_KDSEG;
-	t->tf.ss = SEL_KDSEG;
-	t->tf.cs = SEL_KCSEG;
-	t->tf.eflags = FLAG_IF;
+	 * 첫 switch_to()가 pop할 프레임을 스택 꼭대기에 만든다. ret 직후
+	 * rsp가 16바이트 정렬되도록 한 칸 띄운다. */
+	sf = (struct switch_frame *)((uint8_t *)t + PGSIZE - 16) - 1;
+	memset(sf, 0, sizeof *sf);
+	sf->rbx = (uint64_t)kernel_thread;
+	sf->r12 = (uint64_t)function;
+	sf->r13 = (uint64_t)aux;
+	sf->rip = switch_entry;
+	t->rsp = (uint64_t)sf;
+
+	create_cnt++;
+	create_cycles += rdtsc() - start;
 
 	/* Add to run queue. */
 	thread_unblock(t);
@@ -254,15 +550,6 @@ void thread_block(void)
 	schedule();
 }
 
-bool thread_priority_greater(const struct list_elem *a,
-							 const struct list_elem *b, void *aux)
-{
-	const struct thread *t1 = list_entry(a, struct thread, elem);
-	const struct thread *t2 = list_entry(b, struct thread, elem);
-
-	return t1->priority > t2->priority;
-}
-
 /* Transitions a blocked thread T to the ready-to-run state.
    This is an error if T is not blocked.  (Use thread_yield() to
    make the running thread ready.)
@@ -285,8 +572,7 @@ bool thread_priority_greater(const struct list_elem *a,
 // 	intr_set_level(old_level);
 // }
 /*
-	list_insert_ordered() : 삽입 시 정렬을 유지하면서 삽입
-	thread_priority_greater : 내림차순 정렬을 위한 함수
+	ready_push() : 우선순위에 해당하는 ready 큐 뒤에 O(1)로 삽입
 	intr_yield_on_return() : 타이머 irq 컨텍스트에서도
 							안전하게 다음에 스케줄링 하도록 예약
 */
@@ -298,32 +584,71 @@ void thread_unblock(struct thread *t)
 
 	old_level = intr_disable();
 	ASSERT(t->status == THREAD_BLOCKED);
-	// list_push_back(&ready_list, &t->elem);
-	list_insert_ordered(&ready_list, &t->elem, thread_priority_greater, NULL);
+
+	/* 실시간 스레드: 남은 예산을 남은 시간 안에 쓰면 예약 비율을 넘는
+	   경우(또는 마감이 지난 경우) 새 주기를 시작한다 (CBS 규칙). */
+	if (t->rt_period != 0)
+	{
+		int64_t now = timer_ticks();
+
+		if (now >= t->rt_deadline ||
+			(int64_t)t->rt_left * t->rt_period > (t->rt_deadline - now) * t->rt_budget)
+		{
+			t->rt_deadline = now + t->rt_period;
+			t->rt_left = t->rt_budget;
+		}
+	}
+
+	/* 잠든 사이 놓친 recent_cpu 감쇠를 적용하고 priority를 다시 계산 */
+	if (thread_mlfqs && t->mlfqs_epoch != mlfqs_epoch)
+	{
+		mlfqs_calculate_recent_cpu(t);
+		mlfqs_calculate_priority(t);
+	}
+	ready_push(t);
 	t->status = THREAD_READY;
+	t->woken = true;
+
+	/* idle 중 tickless 대기였다면 정상 틱으로 복귀 */
+	timer_idle_exit();
+
+	/* 인터럽트(타이머 등)가 깨운 실시간 스레드는 인터럽트가 끝나는 즉시
+	   실행한다. 스레드 문맥에서는 호출자의 thread_preempt()가 처리한다. */
+	if (intr_context() && rt_should_preempt())
+		intr_yield_on_return();
 	intr_set_level(old_level);
 
 	/* 우선순위 선점은 절대로 unblock 함수 내에서 수행 되면 안된다. */
 	// thread_preempt();
 }
 
-/* 더 높은 우선순위면 선점 예약/실행 */
+/* 더 높은 우선순위면 선점 예약/실행.
+   stride 스케줄러는 우선순위를 쓰지 않고 time slice 끝에서만 바꾼다. */
 void thread_preempt(void)
 {
-	if (list_empty(&ready_list))
+	/* 마감이 더 이른 실시간 스레드가 있으면 어떤 클래스보다 먼저 */
+	if (rt_should_preempt())
 	{
+		preempt_current();
 		return;
 	}
-	struct list_elem *e = list_begin(&ready_list);
-	struct thread *t = list_entry(e, struct thread, elem);
+	if (thread_stride || thread_current()->rt_period != 0)
+		return;
 
-	if (t->priority > thread_get_priority())
-	{
-		if (intr_context())
-			intr_yield_on_return();
-		else
-			thread_yield();
-	}
+	if (ready_max_priority() > thread_get_priority())
+		preempt_current();
+}
+
+/* 현재 스레드를 선점한다: 인터럽트 안이면 복귀 시 양보를 예약하고,
+   아니면 바로 양보한다. */
+static void
+preempt_current(void)
+{
+	preempt_cnt[thread_get_priority()]++;
+	if (intr_context())
+		intr_yield_on_return();
+	else
+		thread_yield();
 }
 
 /* Returns the name of the running thread. */
@@ -373,11 +698,15 @@ void thread_exit(void)
 	/* all_list에서 스레드 제거 */
 	list_remove(&thread_current()->allelem);
 
-	/* fd_table 페이지 해제 */
-	palloc_free_page(thread_current()->fd_table);
+	/* 늘어난 fd 테이블 반납 */
+	if (thread_current()->fd_table != thread_current()->fd_inline)
+		free(thread_current()->fd_table);
 	thread_current()->fd_table = NULL;
 
 	intr_disable();
+	rt_util_total -= thread_current()->rt_util; /* 실시간 예약 반납 */
+	if (thread_current()->mlfqs_dirty)
+		list_remove(&thread_current()->mlfqs_elem);
 	do_schedule(THREAD_DYING);
 	NOT_REACHED();
 }
@@ -405,11 +734,15 @@ void thread_yield(void)
 	ASSERT(!intr_context());
 
 	old_level = intr_disable();
-	if (curr != idle_thread)
+	/* 예산을 다 쓴 실시간 스레드는 rt_replenish()가 깨울 때까지 쉰다 */
+	if (curr->rt_throttled)
 	{
-		// list_push_back(&ready_list, &curr->elem);
-		list_insert_ordered(&ready_list, &curr->elem, thread_priority_greater, NULL);
+		do_schedule(THREAD_BLOCKED);
+		intr_set_level(old_level);
+		return;
 	}
+	if (curr != idle_thread)
+		ready_push(curr);
 	do_schedule(THREAD_READY);
 	intr_set_level(old_level);
 }
@@ -430,6 +763,131 @@ void thread_set_priority(int new_priority)
 	thread_preempt();
 }
 
+/* 현재 스레드의 티켓 수를 TICKETS로 바꾼다. 1..TICKETS_MAX가 아니면
+   false. 다음 틱부터 새 stride로 pass가 늘어난다. */
+bool thread_set_tickets(int tickets)
+{
+	struct thread *cur = thread_current();
+	enum intr_level old_level;
+
+	if (tickets < 1 || tickets > TICKETS_MAX)
+		return false;
+
+	old_level = intr_disable();
+	cur->tickets = tickets;
+	cur->stride = STRIDE1 / tickets;
+	intr_set_level(old_level);
+	return true;
+}
+
+/* 현재 스레드의 티켓 수 */
+int thread_get_tickets(void)
+{
+	return thread_current()->tickets;
+}
+
+/* 현재 스레드를 실시간(EDF) 클래스로 만든다: PERIOD 틱마다 BUDGET
+   틱의 CPU를 마감 시각(주기 끝) 순으로 보장받는다. 예약 비율의 합이
+   RT_UTIL_MAX를 넘으면 거절하고 false. BUDGET이 0이면 일반 클래스로
+   돌아간다. */
+bool thread_set_realtime(int budget, int period)
+{
+	struct thread *cur = thread_current();
+	enum intr_level old_level;
+	int util = 0;
+
+	if (budget < 0 || (budget > 0 && (period <= 0 || budget > period)))
+		return false;
+	/* budget * 1000은 int를 넘칠 수 있으므로 64비트로 계산한다 (util <= 1000) */
+	if (budget > 0)
+		util = DIV_ROUND_UP((int64_t)budget * 1000, period);
+
+	old_level = intr_disable();
+	if (rt_util_total - cur->rt_util + util > RT_UTIL_MAX)
+	{
+		intr_set_level(old_level);
+		return false;
+	}
+	rt_util_total += util - cur->rt_util;
+	cur->rt_util = util;
+	cur->rt_budget = budget;
+	cur->rt_period = budget > 0 ? period : 0;
+	cur->rt_left = budget;
+	cur->rt_deadline = timer_ticks() + period;
+	intr_set_level(old_level);
+
+	/* 일반 클래스로 돌아갔다면 대기 중인 실시간 스레드에 양보 */
+	thread_preempt();
+	return true;
+}
+
+/* 현재 스레드가 놓친 마감 횟수 */
+int thread_get_rt_misses(void)
+{
+	return thread_current()->rt_misses;
+}
+
+/* 현재 스레드(RUSAGE_SELF)나 종료한 자식들(RUSAGE_CHILDREN)의
+   CPU 사용량을 RU에 복사한다. WHO가 잘못됐으면 false. */
+bool thread_get_rusage(int who, struct rusage *ru)
+{
+	struct thread *cur = thread_current();
+	struct cpu_usage usage;
+	enum intr_level old_level;
+
+	if (who != RUSAGE_SELF && who != RUSAGE_CHILDREN)
+		return false;
+
+	/* thread_tick이나 자식의 종료가 도중에 값을 바꾸지 않도록 */
+	old_level = intr_disable();
+	usage = who == RUSAGE_SELF ? cur->rusage : cur->rusage_children;
+	intr_set_level(old_level);
+
+	ru->utime = usage.utime;
+	ru->stime = usage.stime;
+	ru->wait_ns = usage.wait_ns;
+	ru->nvcsw = usage.nvcsw;
+	ru->nivcsw = usage.nivcsw;
+	return true;
+}
+
+/* 실시간 스레드의 다음 주기: 예산을 채우고 throttle을 푼다. */
+static void
+rt_replenish(struct timer_event *ev)
+{
+	struct thread *t = (struct thread *)((uint8_t *)ev - offsetof(struct thread, rt_event));
+
+	t->rt_throttled = false;
+	t->rt_deadline += t->rt_period;
+	t->rt_left = t->rt_budget;
+	thread_unblock(t);
+}
+
+/* 지금 스레드보다 마감이 이른 실시간 스레드가 ready 상태인지 */
+static bool
+rt_should_preempt(void)
+{
+	struct thread *cur = running_thread();
+	enum intr_level old_level = intr_disable();
+	bool preempt;
+
+	if (list_empty(&rt_queue))
+		preempt = false;
+	else if (cur->rt_period == 0 || cur->rt_throttled)
+		preempt = true;
+	else
+		preempt = list_entry(list_front(&rt_queue), struct thread, elem)->rt_deadline < cur->rt_deadline;
+	intr_set_level(old_level);
+	return preempt;
+}
+
+/* rt_queue 정렬 기준: 마감이 이른 순, 같으면 먼저 온 순 */
+static bool
+rt_deadline_less(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
+{
+	return list_entry(a, struct thread, elem)->rt_deadline < list_entry(b, struct thread, elem)->rt_deadline;
+}
+
 /* Returns the current thread's priority. */
 int thread_get_priority(void)
 {
@@ -504,6 +962,18 @@ idle(void *idle_started_ UNUSED)
 		intr_disable();
 		thread_block();
 
+		/* 할 일이 없는 동안 빈 페이지를 미리 0으로 채워 둔다.
+		   인터럽트를 켜 두므로 깨어난 스레드가 있으면 곧바로 양보한다. */
+		intr_enable();
+		while (ready_cnt == 0 && palloc_prezero())
+			continue;
+		intr_disable();
+		if (ready_cnt > 0)
+			continue;
+
+		/* 깨울 스레드가 없는 동안 빈 타이머 틱을 건너뛴다 (-tickless). */
+		timer_idle_enter();
+
 		/* Re-enable interrupts and wait for the next one.
 
 		   The `sti' instruction disables interrupts until the
@@ -543,10 +1013,17 @@ init_thread(struct thread *t, const char *name, int priority)
 	memset(t, 0, sizeof *t);
 	t->status = THREAD_BLOCKED;
 	strlcpy(t->name, name, sizeof t->name);
-	t->tf.rsp = (uint64_t)t + PGSIZE - sizeof(void *);
 	t->priority = priority;
 	t->magic = THREAD_MAGIC;
 
+	/* stride: 티켓은 만든 스레드에게서 물려받고, pass는 현재 가상 시간부터 */
+	t->tickets = t != running_thread() ? running_thread()->tickets : TICKETS_DEFAULT;
+	t->stride = STRIDE1 / t->tickets;
+	t->pass = stride_pass;
+
+	/* 실시간 클래스는 물려받지 않는다 */
+	timer_event_init(&t->rt_event, rt_replenish);
+
 	/* priority donate를 위한 변수들 초기화*/
 	t->base_priority = priority;
 	list_init(&t->donation_list);
@@ -555,6 +1032,7 @@ init_thread(struct thread *t, const char *name, int priority)
 	/* mlfqs를 위한 변수들 초기화 */
 	t->nice = NICE_DEFAULT;
 	t->recent_cpu = RECENT_CPU_DEFAULT;
+	t->mlfqs_epoch = mlfqs_epoch;
 
 	/* userprog 종료상태 변수 초기화 */
 	t->exit_status = -1;
@@ -563,7 +1041,9 @@ init_thread(struct thread *t, const char *name, int priority)
 	t->parent_tid = TID_ERROR;
 	list_init(&t->children);
 
-	t->fd_table = NULL;
+	t->fd_table = t->fd_inline;
+	t->fd_used = &t->fd_used_inline;
+	t->fd_cap = FD_INLINE;
 
 	/* 스레드 등록 코드 추가
 	 allelem은 struct thread에 있어야 함
@@ -579,10 +1059,175 @@ init_thread(struct thread *t, const char *name, int priority)
 static struct thread *
 next_thread_to_run(void)
 {
-	if (list_empty(&ready_list))
-		return idle_thread;
+	struct thread *t = ready_pop();
+
+	return t != NULL ? t : idle_thread;
+}
+
+/* 가장 먼저 실행할 ready 스레드를 꺼낸다. 없으면 NULL.
+   실시간 클래스, stride 힙, 우선순위 큐 순으로 본다. */
+static struct thread *
+ready_pop(void)
+{
+	struct thread *t = NULL;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (!list_empty(&rt_queue))
+	{
+		int64_t now = timer_ticks();
+
+		t = list_entry(list_pop_front(&rt_queue), struct thread, elem);
+		ready_cnt--;
+
+		/* 기다리는 동안 마감이 지났다 */
+		if (now >= t->rt_deadline)
+		{
+			t->rt_misses++;
+			t->rt_deadline = now + t->rt_period;
+			t->rt_left = t->rt_budget;
+		}
+	}
+	else if (thread_stride)
+	{
+		t = stride_heap;
+		if (t != NULL)
+		{
+			stride_heap = stride_merge(t->stride_left, t->stride_right);
+			stride_pass = t->pass;
+			ready_cnt--;
+		}
+	}
+	else if (ready_mask != 0)
+	{
+		int pri = 63 - __builtin_clzll(ready_mask);
+
+		t = list_entry(list_pop_front(&ready_queues[pri]), struct thread, elem);
+		if (list_empty(&ready_queues[pri]))
+			ready_mask &= ~(1ULL << pri);
+		ready_cnt--;
+	}
+	return t;
+}
+
+/* T를 우선순위 ready 큐 맨 뒤에 넣는다.
+   인터럽트가 꺼져 있어야 한다. */
+static void
+ready_push(struct thread *t)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(PRI_MIN <= t->priority && t->priority <= PRI_MAX);
+
+	t->ready_since = timer_ns();
+	if (t->rt_period != 0)
+		list_insert_ordered(&rt_queue, &t->elem, rt_deadline_less, NULL);
+	else if (thread_stride)
+	{
+		/* 오래 잠들었던 스레드가 밀린 pass로 CPU를 독점하지 않도록
+		   현재 가상 시간보다 뒤처진 pass는 끌어올린다. */
+		if (t->pass < stride_pass)
+			t->pass = stride_pass;
+		t->stride_left = t->stride_right = NULL;
+		t->stride_rank = 1;
+		stride_heap = stride_merge(stride_heap, t);
+	}
 	else
-		return list_entry(list_pop_front(&ready_list), struct thread, elem);
+	{
+		list_push_back(&ready_queues[t->priority], &t->elem);
+		ready_mask |= 1ULL << t->priority;
+	}
+	ready_cnt++;
+}
+
+/* 힙 노드 T의 rank: 가장 가까운 빈 자식까지의 거리 */
+static int
+stride_rank(const struct thread *t)
+{
+	return t != NULL ? t->stride_rank : 0;
+}
+
+/* pass 순 leftist 힙 A와 B를 합친다. 오른쪽 척추의 길이가
+   O(log n)으로 유지되므로 삽입과 삭제 모두 O(log n)이다. */
+static struct thread *
+stride_merge(struct thread *a, struct thread *b)
+{
+	struct thread *tmp;
+
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+	if (b->pass < a->pass)
+	{
+		tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	a->stride_right = stride_merge(a->stride_right, b);
+	if (stride_rank(a->stride_left) < stride_rank(a->stride_right))
+	{
+		tmp = a->stride_left;
+		a->stride_left = a->stride_right;
+		a->stride_right = tmp;
+	}
+	a->stride_rank = stride_rank(a->stride_right) + 1;
+	return a;
+}
+
+/* ready 큐에 있는 T를 꺼낸다. 큐가 비면 비트맵의 해당 비트도 내린다. */
+static void
+ready_remove(struct thread *t)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	list_remove(&t->elem);
+	if (list_empty(&ready_queues[t->priority]))
+		ready_mask &= ~(1ULL << t->priority);
+	ready_cnt--;
+}
+
+/* ready 스레드 중 가장 높은 우선순위, 없으면 -1.
+   __builtin_clzll()은 bsr 한 번으로 컴파일된다. */
+static int
+ready_max_priority(void)
+{
+	if (ready_mask == 0)
+		return -1;
+	return 63 - __builtin_clzll(ready_mask);
+}
+
+/* T의 (유효) 우선순위를 PRIORITY로 바꾼다.
+   T가 ready 상태면 새 우선순위의 큐로 옮기고, 대기 힙(wait_heap)에 들어 있으면
+   상태와 상관없이 힙에서 자리를 고친다. cond_wait()는 lock_release() 전에
+   condvar 힙에 들어가므로, 아직 RUNNING/READY인 동안에도 기부가 풀려
+   우선순위가 내려갈 수 있다. 인터럽트가 꺼져 있어야 한다. */
+static void
+thread_change_priority(struct thread *t, int priority)
+{
+	bool requeue, raised;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (t->priority == priority)
+		return;
+	requeue = t->status == THREAD_READY && !thread_stride && t->rt_period == 0;
+	raised = priority > t->priority;
+
+	if (requeue)
+		ready_remove(t);
+	t->priority = priority;
+	if (requeue)
+		ready_push(t);
+
+	if (t->wait_heap != NULL)
+	{
+		/* 기부로 올라가면 decrease-key(O(1)), 내려가면 빼고 다시 넣는다. */
+		if (raised)
+			heap_raise(t->wait_heap, t->wait_helem);
+		else
+			heap_update(t->wait_heap, t->wait_helem);
+	}
 }
 
 /* Use iretq to launch the thread */
@@ -613,73 +1258,22 @@ void do_iret(struct intr_frame *tf)
 		: : "g"((uint64_t)tf) : "memory");
 }
 
-/* Switching the thread by activating the new thread's page
-   tables, and, if the previous thread is dying, destroying it.
+/* Switches from the running thread to TH.
 
-   At this function's invocation, we just switched from thread
-   PREV, the new thread is already running, and interrupts are
-   still disabled.
+   Kernel-to-kernel switches only need the callee-saved registers,
+   the stack pointer and the return address, which switch_to()
+   keeps on each thread's kernel stack.  The full intr_frame and
+   iretq (do_iret()) are used only to enter user mode.
 
-   It's not safe to call printf() until the thread switch is
-   complete.  In practice that means that printf()s should be
-   added at the end of the function. */
+   At this function's invocation interrupts are disabled, and
+   switch_to() returns here in TH's context once some other
+   thread switches back to it. */
 static void
 thread_launch(struct thread *th)
 {
-	uint64_t tf_cur = (uint64_t)&running_thread()->tf;
-	uint64_t tf = (uint64_t)&th->tf;
 	ASSERT(intr_get_level() == INTR_OFF);
 
-	/* The main switching logic.
-	 * We first restore the whole execution context into the intr_frame
-	 * and then switching to the next thread by calling do_iret.
-	 * Note that, we SHOULD NOT use any stack from here
-	 * until switching is done. */
-	__asm __volatile(
-		/* Store registers that will be used. */
-		"push %%rax\n"
-		"push %%rbx\n"
-		"push %%rcx\n"
-		/* Fetch input once */
-		"movq %0, %%rax\n"
-		"movq %1, %%rcx\n"
-		"movq %%r15, 0(%%rax)\n"
-		"movq %%r14, 8(%%rax)\n"
-		"movq %%r13, 16(%%rax)\n"
-		"movq %%r12, 24(%%rax)\n"
-		"movq %%r11, 32(%%rax)\n"
-		"movq %%r10, 40(%%rax)\n"
-		"movq %%r9, 48(%%rax)\n"
-		"movq %%r8, 56(%%rax)\n"
-		"movq %%rsi, 64(%%rax)\n"
-		"movq %%rdi, 72(%%rax)\n"
-		"movq %%rbp, 80(%%rax)\n"
-		"movq %%rdx, 88(%%rax)\n"
-		"pop %%rbx\n" // Saved rcx
-		"movq %%rbx, 96(%%rax)\n"
-		"pop %%rbx\n" // Saved rbx
-		"movq %%rbx, 104(%%rax)\n"
-		"pop %%rbx\n" // Saved rax
-		"movq %%rbx, 112(%%rax)\n"
-		"addq $120, %%rax\n"
-		"movw %%es, (%%rax)\n"
-		"movw %%ds, 8(%%rax)\n"
-		"addq $32, %%rax\n"
-		"call __next\n" // read the current rip.
-		"__next:\n"
-		"pop %%rbx\n"
-		"addq $(out_iret -  __next), %%rbx\n"
-		"movq %%rbx, 0(%%rax)\n" // rip
-		"movw %%cs, 8(%%rax)\n"	 // cs
-		"pushfq\n"
-		"popq %%rbx\n"
-		"mov %%rbx, 16(%%rax)\n" // eflags
-		"mov %%rsp, 24(%%rax)\n" // rsp
-		"movw %%ss, 32(%%rax)\n"
-		"mov %%rcx, %%rdi\n"
-		"call do_iret\n"
-		"out_iret:\n"
-		: : "g"(tf_cur), "g"(tf) : "memory");
+	switch_to(&running_thread()->rsp, th->rsp);
 }
 
 /* Schedules a new process. At entry, interrupts must be off.
@@ -695,7 +1289,7 @@ do_schedule(int status)
 	{
 		struct thread *victim =
 			list_entry(list_pop_front(&destruction_req), struct thread, elem);
-		palloc_free_page(victim);
+		cache_push(thread_page_cache, &thread_page_cnt, victim);
 	}
 	thread_current()->status = status;
 	schedule();
@@ -710,6 +1304,31 @@ schedule(void)
 	ASSERT(intr_get_level() == INTR_OFF);
 	ASSERT(curr->status != THREAD_RUNNING);
 	ASSERT(is_thread(next));
+
+	/* 문맥 교환 통계: 막혀서 내주면 자발적, 아직 실행 가능한데
+	   빼앗기거나 양보하면 비자발적. ready 큐에서 기다린 시간도 더한다.
+	   지연 히스토그램: 내주는 쪽은 실행한 시간, 받는 쪽은 깨어난 뒤
+	   기다린 시간을 남긴다. */
+	if (curr != next)
+	{
+		int64_t now = timer_ns();
+
+		if (curr->status == THREAD_BLOCKED)
+			curr->rusage.nvcsw++;
+		else if (curr->status == THREAD_READY)
+			curr->rusage.nivcsw++;
+		if (curr != idle_thread)
+			lat_record(slice_hist, curr->priority, now - curr->run_since);
+		if (next != idle_thread)
+		{
+			next->rusage.wait_ns += now - next->ready_since;
+			if (next->woken)
+				lat_record(wake_hist, next->priority, now - next->ready_since);
+		}
+		next->woken = false;
+		next->run_since = now;
+	}
+
 	/* Mark us as running. */
 	next->status = THREAD_RUNNING;
 
@@ -769,7 +1388,7 @@ void thread_donate_priority(void)
 	{
 		struct thread *holder = lock->holder;
 
-		holder->priority = cur->priority;
+		thread_change_priority(holder, cur->priority);
 
 		/* 중복 기부 방지를 위해 전체 순회 , donation_list 검사 -> nest 방지
 			donation_elem 은 기부자들 리스트이므로 중복된 사람이 들어올 필요X
@@ -816,6 +1435,7 @@ void thread_remove_donations_for_lock(struct lock *lock)
 							우선순위 업데이트해주는 함수*/
 void thread_update_priority(void)
 {
+	enum intr_level old_level = intr_disable();
 	struct thread *cur = thread_current();
 	struct list_elem *e = list_begin(&cur->donation_list);
 	int max_prio = cur->base_priority;
@@ -829,16 +1449,9 @@ void thread_update_priority(void)
 			max_prio = donor->priority;
 		}
 	}
-	cur->priority = max_prio;
-
-	/* ready_list에서 삽입 후 우선순위 변경이 이루어 졌을 때 다시 정렬
-		우선순위 기부받은 스레드가 가장 큰 스레드이므로 삭제후 맨 앞 삽입
-	*/
-	if (cur->status == THREAD_READY)
-	{
-		list_remove(&cur->elem);
-		list_push_front(&ready_list, &cur->elem);
-	}
+	/* ready 상태라면 thread_change_priority()가 새 우선순위 큐로 옮긴다 */
+	thread_change_priority(cur, max_prio);
+	intr_set_level(old_level);
 }
 
 /* mlfqs를 위한 함수들*/
@@ -847,15 +1460,60 @@ void mlfqs_calculate_priority(struct thread *t)
 {
 	if (t == idle_thread)
 		return;
-	t->priority = fp_to_int(add_mixed(div_mixed(t->recent_cpu, -4), PRI_MAX - t->nice * 2));
+	int priority = fp_to_int(add_mixed(div_mixed(t->recent_cpu, -4), PRI_MAX - t->nice * 2));
+
+	/* ready 큐 인덱스로 쓰이므로 PRI_MIN..PRI_MAX로 자른다 */
+	if (priority < PRI_MIN)
+		priority = PRI_MIN;
+	else if (priority > PRI_MAX)
+		priority = PRI_MAX;
+	thread_change_priority(t, priority);
 }
 
-/* 스레드의 recent_cpu 값을 계산하는 함수 */
+/* recent_cpu 감쇠를 T가 놓친 초만큼 따라잡는다.
+   매 초 감쇠는 실행 가능한 스레드에만 바로 적용하고, 블락된 스레드는
+   깨어날 때 여기서 한꺼번에 적용한다. 최근 DECAY_HISTORY 초의 계수는
+   decay_coeff[]에 남아 있어 매 초 계산한 것과 같은 값이 나온다.
+   그보다 오래 잠들었으면 남아 있는 가장 오래된 계수로 앞부분을
+   닫힌 식 rc * c^k + nice * (1 - c^k) / (1 - c)로 한 번에 계산한다. */
 void mlfqs_calculate_recent_cpu(struct thread *t)
 {
-	if (t == idle_thread)
+	unsigned gap = mlfqs_epoch - t->mlfqs_epoch;
+	int rc = t->recent_cpu;
+
+	if (t == idle_thread || gap == 0)
+		return;
+
+	if (gap > DECAY_HISTORY)
+	{
+		int c = decay_coeff[(mlfqs_epoch - DECAY_HISTORY) % DECAY_HISTORY];
+		int ck = int_to_fp(1), base = c;
+
+		for (unsigned k = gap - DECAY_HISTORY; k != 0; k >>= 1)
+		{
+			if (k & 1)
+				ck = mult_fp(ck, base);
+			base = mult_fp(base, base);
+		}
+		rc = add_fp(mult_fp(ck, rc),
+					mult_mixed(div_fp(sub_fp(int_to_fp(1), ck), sub_fp(int_to_fp(1), c)), t->nice));
+		gap = DECAY_HISTORY;
+	}
+	for (unsigned e = mlfqs_epoch - gap; e != mlfqs_epoch; e++)
+		rc = add_mixed(mult_fp(decay_coeff[e % DECAY_HISTORY], rc), t->nice);
+
+	t->recent_cpu = rc;
+	t->mlfqs_epoch = mlfqs_epoch;
+}
+
+/* T의 priority를 다음 재계산 때 다시 계산하도록 표시한다. */
+static void
+mlfqs_mark_dirty(struct thread *t)
+{
+	if (t == idle_thread || t->mlfqs_dirty)
 		return;
-	t->recent_cpu = add_mixed(mult_fp(div_fp(mult_mixed(load_avg, 2), add_mixed(mult_mixed(load_avg, 2), 1)), t->recent_cpu), t->nice);
+	t->mlfqs_dirty = true;
+	list_push_back(&mlfqs_dirty_list, &t->mlfqs_elem);
 }
 
 /* load_avg 값을 계산하는 함수*/
@@ -864,91 +1522,72 @@ void mlfqs_calculate_load_avg(void)
 	int ready_threads;
 
 	if (thread_current() == idle_thread)
-		ready_threads = list_size(&ready_list);
+		ready_threads = ready_cnt;
 	else
-		ready_threads = list_size(&ready_list) + 1;
+		ready_threads = ready_cnt + 1;
 
 	load_avg = add_fp(mult_fp(div_fp(int_to_fp(59), int_to_fp(60)), load_avg),
 					  mult_mixed(div_fp(int_to_fp(1), int_to_fp(60)), ready_threads));
 }
 
-/* 현재 스레드의 recent_cpu의 값을 1 증가 */
+/* 현재 스레드의 recent_cpu의 값을 1 증가.
+   recent_cpu가 바뀌었으니 다음 재계산 대상에 넣는다. */
 void mlfqs_increment_recent_cpu(void)
 {
-	if (thread_current() != idle_thread)
-		thread_current()->recent_cpu = add_mixed(thread_current()->recent_cpu, 1);
+	struct thread *cur = thread_current();
+
+	if (cur != idle_thread)
+	{
+		cur->recent_cpu = add_mixed(cur->recent_cpu, 1);
+		mlfqs_mark_dirty(cur);
+	}
 }
 
-/*모든 스레드의 recent_cpu 재계산*/
+/* 1초마다: 이번 초의 감쇠 계수를 기록하고, 실행 가능한 스레드(실행 중 +
+   ready 큐)의 recent_cpu만 감쇠시킨다. 블락된 스레드는 깨어날 때
+   mlfqs_calculate_recent_cpu()로 따라잡는다. */
 void mlfqs_recalculate_recent_cpu(void)
 {
-	struct list_elem *e;
+	struct thread *cur = thread_current();
 
-	for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
+	decay_coeff[mlfqs_epoch % DECAY_HISTORY] =
+		div_fp(mult_mixed(load_avg, 2), add_mixed(mult_mixed(load_avg, 2), 1));
+	mlfqs_epoch++;
+
+	if (cur != idle_thread)
 	{
-		struct thread *t = list_entry(e, struct thread, allelem);
-		mlfqs_calculate_recent_cpu(t);
+		mlfqs_calculate_recent_cpu(cur);
+		mlfqs_mark_dirty(cur);
+	}
+	for (uint64_t mask = ready_mask; mask != 0;)
+	{
+		int pri = 63 - __builtin_clzll(mask);
+		struct list_elem *e;
+
+		mask &= ~((uint64_t)1 << pri);
+		for (e = list_begin(&ready_queues[pri]); e != list_end(&ready_queues[pri]); e = list_next(e))
+		{
+			struct thread *t = list_entry(e, struct thread, elem);
+			mlfqs_calculate_recent_cpu(t);
+			mlfqs_mark_dirty(t);
+		}
 	}
 }
 
-/* 모든 스레드의 priority를 재계산*/
+/* 4틱마다: recent_cpu가 바뀐 스레드의 priority만 다시 계산한다.
+   대상은 그 사이 실행된 스레드(최대 4개)와, 초 경계라면 실행 가능한
+   스레드들이다. */
 void mlfqs_recalculate_priority(void)
 {
-	struct list_elem *e;
-
-	for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
+	while (!list_empty(&mlfqs_dirty_list))
 	{
-		struct thread *t = list_entry(e, struct thread, allelem);
+		struct thread *t = list_entry(list_pop_front(&mlfqs_dirty_list),
+									  struct thread, mlfqs_elem);
+		t->mlfqs_dirty = false;
 		mlfqs_calculate_priority(t);
 	}
 }
 
-/* fixed_point를 위한 함수 선언 및 정의 */
-int int_to_fp(int n)
-{
-	return n * F;
-}
-int fp_to_int(int x)
-{
-	return x / F;
-}
-int fp_to_int_round(int x)
-{
-	return x >= 0 ? (x + F / 2) / F : (x - F / 2) / F;
-}
-int add_fp(int x, int y)
-{
-	return x + y;
-}
-int sub_fp(int x, int y)
-{
-	return x - y;
-}
-int add_mixed(int x, int n)
-{
-	return x + n * F;
-}
-int sub_mixed(int x, int n)
-{
-	return x - n * F;
-}
-int mult_fp(int x, int y)
-{
-	return (int64_t)x * y / F;
-}
-int mult_mixed(int x, int n)
-{
-	return x * n;
-}
-int div_fp(int x, int y)
-{
-	return (int64_t)x * F / y;
-}
-int div_mixed(int x, int n)
-{
-	return x / n;
-}
-
 /* tid로 스레드를 검색해 반환 */
 struct thread *
 thread_by_tid(tid_t tid)
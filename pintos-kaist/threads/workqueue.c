@@ -0,0 +1,253 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* 커널 workqueue.
+
+   큐마다 대기 중인 work 리스트와, 큐의 우선순위로 thread_create()한
+   고정된 수의 worker 스레드를 가진다. 대기 리스트는 인터럽트 핸들러
+   (delayed work면 타이머 인터럽트)도 건드리므로 락이 아니라 인터럽트를
+   꺼서 보호한다. READY는 큐에 들어온 항목 수를 센다. 항목이 취소되어
+   빈 리스트를 보고 깨어난 worker는 그냥 다시 잠든다. */
+
+/* workqueue 하나 */
+struct workqueue {
+	char name[16];                  /* worker 스레드 이름에 쓸 이름 */
+	struct list pending;            /* 큐에 들어온 work들 */
+	struct semaphore ready;         /* 항목 하나 들어올 때마다 up */
+	int workers;                    /* worker 스레드 수 */
+	int active;                     /* 지금 실행 중인 항목 수 */
+	int flush_waiters;              /* workqueue_flush()에서 기다리는 스레드 수 */
+	struct semaphore flushed;       /* 큐가 비면 기다리는 스레드마다 up */
+};
+
+struct workqueue *system_wq;
+int system_wq_workers = 1;
+
+static void worker_loop (void *wq_);
+static void wake_flushers (struct workqueue *);
+static void delayed_work_fire (struct timer_event *);
+
+/* 공용 system workqueue를 만든다. thread_start() 뒤에 불러야 한다. */
+void
+workqueue_init (void) {
+	system_wq = workqueue_create ("kworker", PRI_DEFAULT, system_wq_workers);
+	if (system_wq == NULL)
+		PANIC ("cannot create system workqueue");
+}
+
+/* PRIORITY로 도는 WORKERS개의 스레드가 처리하는 NAME이라는 workqueue를
+   만든다. 인자가 범위를 벗어나거나 worker를 하나도 못 띄우면 NULL.
+   큐는 없애지 않는다. */
+struct workqueue *
+workqueue_create (const char *name, int priority, int workers) {
+	struct workqueue *wq;
+	int i;
+
+	ASSERT (name != NULL);
+	if (priority < PRI_MIN || priority > PRI_MAX
+	    || workers < 1 || workers > WQ_MAX_WORKERS)
+		return NULL;
+
+	wq = malloc (sizeof *wq);
+	if (wq == NULL)
+		return NULL;
+	strlcpy (wq->name, name, sizeof wq->name);
+	list_init (&wq->pending);
+	sema_init (&wq->ready, 0);
+	wq->workers = 0;
+	wq->active = 0;
+	wq->flush_waiters = 0;
+	sema_init (&wq->flushed, 0);
+
+	/* worker는 아래 루프만 돌므로 일부만 떠도 큐는 쓸 수 있다 */
+	for (i = 0; i < workers; i++) {
+		char thread_name[16];
+
+		snprintf (thread_name, sizeof thread_name, "%s/%d", name, i);
+		if (thread_create (thread_name, priority, worker_loop, wq) == TID_ERROR)
+			break;
+		wq->workers++;
+	}
+	if (wq->workers == 0) {
+		free (wq);
+		return NULL;
+	}
+	return wq;
+}
+
+/* WQ에 대기 중이거나 실행 중인 work가 없을 때까지 기다린다.
+   기다리는 동안 새로 들어온 work도 함께 기다린다. 타이머를 기다리는
+   delayed work는 아직 큐에 없으므로 기다리지 않는다.
+   WQ의 worker 안에서 부르면 자기 자신을 기다리게 되므로 안 된다. */
+void
+workqueue_flush (struct workqueue *wq) {
+	enum intr_level old_level;
+
+	ASSERT (!intr_context ());
+
+	old_level = intr_disable ();
+	if (!list_empty (&wq->pending) || wq->active > 0) {
+		wq->flush_waiters++;
+		intr_set_level (old_level);
+		sema_down (&wq->flushed);
+	} else
+		intr_set_level (old_level);
+}
+
+/* work W가 FUNC을 실행하도록 초기화한다. */
+void
+work_init (struct work *w, work_func *func) {
+	ASSERT (w != NULL);
+	ASSERT (func != NULL);
+
+	w->func = func;
+	w->wq = NULL;
+	w->pending = false;
+}
+
+/* W를 WQ에 넣는다. 이미 들어 있으면 아무것도 하지 않고 false.
+   잠들지 않으므로 인터럽트 핸들러에서도 부를 수 있다. W의 함수가
+   시작되고 나면 바로 다시 넣을 수 있다. */
+bool
+work_queue (struct workqueue *wq, struct work *w) {
+	enum intr_level old_level;
+
+	ASSERT (wq != NULL);
+	ASSERT (w != NULL);
+
+	old_level = intr_disable ();
+	if (w->pending) {
+		intr_set_level (old_level);
+		return false;
+	}
+	w->pending = true;
+	w->wq = wq;
+	list_push_back (&wq->pending, &w->elem);
+	intr_set_level (old_level);
+
+	sema_up (&wq->ready);
+	return true;
+}
+
+/* W가 아직 시작 전이면 큐에서 뺀다. 뺐으면 true.
+   이미 실행 중인 함수는 기다리지 않는다. */
+bool
+work_cancel (struct work *w) {
+	enum intr_level old_level;
+	bool cancelled = false;
+
+	old_level = intr_disable ();
+	if (w->pending) {
+		list_remove (&w->elem);
+		w->pending = false;
+		wake_flushers (w->wq);
+		cancelled = true;
+	}
+	intr_set_level (old_level);
+	return cancelled;
+}
+
+/* delayed work DW가 FUNC을 실행하도록 초기화한다. */
+void
+delayed_work_init (struct delayed_work *dw, work_func *func) {
+	work_init (&dw->work, func);
+	timer_event_init (&dw->timer, delayed_work_fire);
+}
+
+/* TICKS 틱 뒤에 DW를 WQ에 넣는다. TICKS가 0 이하면 바로 넣는다.
+   이미 타이머를 기다리거나 큐에 들어 있으면 아무것도 하지 않고 false.
+   인터럽트 핸들러에서도 부를 수 있다. */
+bool
+delayed_work_queue (struct workqueue *wq, struct delayed_work *dw,
+                    int64_t ticks) {
+	enum intr_level old_level;
+
+	ASSERT (wq != NULL);
+
+	if (ticks <= 0)
+		return work_queue (wq, &dw->work);
+
+	old_level = intr_disable ();
+	if (dw->timer.pending || dw->work.pending) {
+		intr_set_level (old_level);
+		return false;
+	}
+	dw->work.wq = wq;
+	timer_event_add (&dw->timer, timer_ticks () + ticks);
+	intr_set_level (old_level);
+	return true;
+}
+
+/* 타이머를 기다리는 중이든 이미 큐에 들어갔든 DW가 실행되지 않게
+   막는다. 막았으면 true. */
+bool
+delayed_work_cancel (struct delayed_work *dw) {
+	enum intr_level old_level;
+	bool cancelled;
+
+	old_level = intr_disable ();
+	cancelled = timer_event_cancel (&dw->timer) || work_cancel (&dw->work);
+	intr_set_level (old_level);
+	return cancelled;
+}
+
+/* delayed work의 타이머 콜백: 이제 큐에 넣는다. */
+static void
+delayed_work_fire (struct timer_event *ev) {
+	struct delayed_work *dw =
+		(struct delayed_work *) ((uint8_t *) ev - offsetof (struct delayed_work, timer));
+
+	work_queue (dw->work.wq, &dw->work);
+}
+
+/* worker 스레드 본체: WQ의 항목을 들어온 순서대로 계속 실행한다. */
+static void
+worker_loop (void *wq_) {
+	struct workqueue *wq = wq_;
+
+	for (;;) {
+		enum intr_level old_level;
+		struct work *w;
+
+		sema_down (&wq->ready);
+
+		old_level = intr_disable ();
+		if (list_empty (&wq->pending)) {
+			/* 세어진 뒤에 취소된 항목 */
+			intr_set_level (old_level);
+			continue;
+		}
+		w = list_entry (list_pop_front (&wq->pending), struct work, elem);
+		w->pending = false;
+		wq->active++;
+		intr_set_level (old_level);
+
+		/* 함수가 W를 해제하거나 다시 넣을 수 있으므로
+		   호출한 뒤에는 W를 건드리지 않는다. */
+		w->func (w);
+
+		old_level = intr_disable ();
+		wq->active--;
+		wake_flushers (wq);
+		intr_set_level (old_level);
+	}
+}
+
+/* WQ가 비었으면 WQ의 workqueue_flush()에서 기다리는 스레드를 모두
+   깨운다. 인터럽트가 꺼져 있어야 한다. */
+static void
+wake_flushers (struct workqueue *wq) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (wq->active > 0 || !list_empty (&wq->pending))
+		return;
+	for (; wq->flush_waiters > 0; wq->flush_waiters--)
+		sema_up (&wq->flushed);
+}
@@ -14,6 +14,7 @@
 #include "threads/init.h"
 #include "threads/interrupt.h"
 #include "threads/palloc.h"
+#include "threads/slab.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "threads/vaddr.h"
@@ -29,6 +30,30 @@ static void process_cleanup(void);
 static bool load(const char *file_name, struct intr_frame *if_);
 static void initd(void *f_name);
 static void __do_fork(void *);
+static void rusage_print(struct thread *t);
+static void rusage_add(struct cpu_usage *dst, const struct cpu_usage *src);
+
+/* 종료할 때 프로세스의 CPU 사용량을 출력할지 (-rusage) */
+bool rusage_at_exit;
+
+/* fork/exec/wait 마다 오가는 작은 구조체들의 전용 캐시 */
+static struct kmem_cache *child_status_slab;
+#ifdef VM
+static struct kmem_cache *load_info_slab;
+#endif
+
+/* 프로세스 관리에 쓰는 객체 캐시를 만든다. 부팅 때 한 번 호출된다. */
+void process_slab_init(void)
+{
+	child_status_slab = kmem_cache_create("child_status", sizeof(struct child_status), NULL);
+	if (child_status_slab == NULL)
+		PANIC("cannot create process object caches");
+#ifdef VM
+	load_info_slab = kmem_cache_create("load_info", sizeof(struct load_info), NULL);
+	if (load_info_slab == NULL)
+		PANIC("cannot create process object caches");
+#endif
+}
 
 /* General process initializer for initd and other process. */
 static void
@@ -36,14 +61,9 @@ process_init(void)
 {
 	struct thread *cur = thread_current();
 
-	cur->fd_table = palloc_get_page(PAL_ZERO);
-	if (cur->fd_table == NULL)
-		PANIC("process_init: cannot alloc fd_table");
-
 	/* console_in/out 은 이미 thread_init() 시점에 초기화해 두었다고 가정 */
-	cur->fd_table[0] = &console_in;
-	cur->fd_table[1] = &console_out;
-	cur->next_fd = 2;
+	thread_fd_set(cur, 0, &console_in);
+	thread_fd_set(cur, 1, &console_out);
 }
 
 /* Starts the first userland program, called "initd", loaded from FILE_NAME.
@@ -72,7 +92,7 @@ tid_t process_create_initd(const char *file_name)
 	strlcpy(prog_name, fn_copy, namelen + 1);
 
 	/* 2) child_status 만들고 부모 리스트에 등록 */
-	struct child_status *c = malloc(sizeof *c);
+	struct child_status *c = kmem_cache_alloc(child_status_slab);
 	if (!c)
 	{
 		palloc_free_page(fn_copy);
@@ -88,7 +108,7 @@ tid_t process_create_initd(const char *file_name)
 	if (tid == TID_ERROR)
 	{
 		list_remove(&c->elem);
-		free(c);
+		kmem_cache_free(child_status_slab, c);
 		palloc_free_page(fn_copy);
 		return TID_ERROR;
 	}
@@ -99,7 +119,7 @@ tid_t process_create_initd(const char *file_name)
 	/* 5) 부모는 initd 준비까지 기다렸다가 리턴 */
 	sema_down(&c->sema);
 	list_remove(&c->elem);
-	free(c);
+	kmem_cache_free(child_status_slab, c);
 
 	return tid;
 }
@@ -133,7 +153,7 @@ tid_t process_fork(const char *name, struct intr_frame *if_ UNUSED)
 	child_if->R.rax = 0;
 
 	/* 2) 부모의 children 리스트에 등록할 구조체 할당 */
-	struct child_status *c = malloc(sizeof *c);
+	struct child_status *c = kmem_cache_alloc(child_status_slab);
 	if (!c)
 	{
 		palloc_free_page(child_if);
@@ -149,7 +169,7 @@ tid_t process_fork(const char *name, struct intr_frame *if_ UNUSED)
 	if (child_tid == TID_ERROR)
 	{
 		list_remove(&c->elem);
-		free(c);
+		kmem_cache_free(child_status_slab, c);
 		palloc_free_page(child_if);
 		return TID_ERROR;
 	}
@@ -241,22 +261,22 @@ __do_fork(void *aux)
 	 * TODO:       from the fork() until this function successfully duplicates
 	 * TODO:       the resources of parent.*/
 
-	for (int fd = 0; fd < MAX_FD; fd++)
+	/* 부모가 쓰는 범위(fd_end)까지만 복사한다.
+	   자식은 0, 1번에 콘솔을 갖고 시작하므로, 부모가 닫은 칸은 비워 준다 */
+	int fd_end = parent->fd_end > 2 ? parent->fd_end : 2;
+	for (int fd = 0; fd < fd_end; fd++)
 	{
-		struct file *f = parent->fd_table[fd];
+		struct file *f = fd < parent->fd_end ? parent->fd_table[fd] : NULL;
 		if (f == NULL)
 		{
-			current->fd_table[fd] = NULL;
-		}
-		else if (f == &console_in || f == &console_out)
-		{
-			/* stdin : console_in 공유 */
-			current->fd_table[fd] = f;
+			thread_fd_set(current, fd, NULL);
+			continue;
 		}
-		else
-			current->fd_table[fd] = file_duplicate(f);
+		if (f != &console_in && f != &console_out)
+			f = file_duplicate(f); /* stdin/stdout : console 공유 */
+		if (f == NULL || !thread_fd_set(current, fd, f))
+			goto error;
 	}
-	current->next_fd = parent->next_fd;
 
 	if (parent != NULL)
 	{
@@ -357,7 +377,7 @@ int process_wait(tid_t child_tid UNUSED)
 	/* 3) 자식 exit_status 가져온 뒤 정리 */
 	int status = c->exit_status;
 	list_remove(&c->elem);
-	free(c);
+	kmem_cache_free(child_status_slab, c);
 	return status;
 }
 
@@ -379,56 +399,16 @@ void process_exit(void)
 		/* 1) 종료 메시지 출력 */
 		printf("%s: exit(%d)\n", curr->name, curr->exit_status);
 
+		if (rusage_at_exit)
+			rusage_print(curr);
 #ifdef VM
-		/* 커널 스레드가 아닌, 사용자 프로세스 페이지만 */
-		if (curr->pml4 != NULL) /* 또는 SPT가 초기화된 스레드만 */
-		{
-			/* 1) SPT 해시 전체 순회하며 file-backed 페이지만 골라 do_munmap 호출 */
-			void **starts = NULL;
-			size_t nstarts = 0;
-
-			struct hash_iterator hi;
-			hash_first(&hi, &curr->spt.spt_hash);
-			while (hash_next(&hi))
-			{
-				struct page *p = hash_entry(hash_cur(&hi), struct page, hash_elem);
-
-				/* 2) 파일 매핑된 페이지만 처리 (VM_FILE 타입) */
-				if (p->operations->type == VM_FILE)
-				{
-					struct file_page *aux = p->uninit.aux;
+		if (memstat_at_exit)
+			memstat_print(curr);
 
-					/* 3) 매핑의 첫 페이지(start_addr)에서만 수집 */
-					if (p->va == aux->start_addr)
-					{
-						/* 4) 중복 저장 방지: 이미 수집된 주소인지 확인 */
-						bool seen = false;
-						for (size_t i = 0; i < nstarts; i++)
-							if (starts[i] == aux->start_addr)
-							{
-								seen = true;
-								break;
-							}
-
-						/* 5) 새로 발견된 시작 주소이면 배열에 추가 */
-						if (!seen)
-						{
-							void **tmp = realloc(starts, sizeof(void *) * (nstarts + 1));
-							if (!tmp)
-								break;
-							starts = tmp;
-							starts[nstarts++] = aux->start_addr;
-						}
-					}
-				}
-			}
-			/* 2) Now unmap each mapping (this mutates the hash, but it’s safe because
-		   we’re no longer iterating it) */
-			for (size_t i = 0; i < nstarts; i++)
-				do_munmap(starts[i]);
-
-			free(starts);
-		}
+		/* 부모가 깨어나기 전에 mmap된 파일 내용을 반영해야 하므로
+		   주소 공간 teardown(fast path)을 여기서 먼저 수행한다.
+		   pml4는 아래 process_cleanup()에서 통째로 파괴된다. */
+		supplemental_page_table_kill(&curr->spt);
 #endif
 		/* 2) 부모에게 exit 상태 전달 및 sema_up() */
 		if (curr->parent_tid != TID_ERROR)
@@ -436,6 +416,12 @@ void process_exit(void)
 			parent = thread_by_tid(curr->parent_tid);
 			if (parent != NULL)
 			{
+				/* 나와 내 자식들의 CPU 사용량을 부모의 자식 합계에 더한다 */
+				enum intr_level old_level = intr_disable();
+				rusage_add(&parent->rusage_children, &curr->rusage);
+				rusage_add(&parent->rusage_children, &curr->rusage_children);
+				intr_set_level(old_level);
+
 				for (e = list_begin(&parent->children);
 					 e != list_end(&parent->children);
 					 e = list_next(e))
@@ -453,20 +439,41 @@ void process_exit(void)
 		}
 
 		// TODO: fd_table 순회하여 file_close()
-		for (int fd = 0; fd < MAX_FD; fd++)
+		for (int fd = curr->fd_end - 1; fd >= 0; fd--)
 		{
 			struct file *f = curr->fd_table[fd];
 			if (f != NULL && f != &console_in /* stdin 예외 */
 				&& f != &console_out)		  /* stdout 예외 */
 			{
-				file_close(curr->fd_table[fd]);
-				curr->fd_table[fd] = NULL;
+				file_close(f);
+				thread_fd_set(curr, fd, NULL);
 			}
 		}
 	}
 	process_cleanup();
 }
 
+/* T의 CPU 사용량을 출력한다 (-rusage). 대기 시간은 us 단위. */
+static void
+rusage_print(struct thread *t)
+{
+	struct cpu_usage *ru = &t->rusage;
+
+	printf("%s: rusage utime=%u stime=%u wait=%lldus nvcsw=%u nivcsw=%u\n",
+		   t->name, ru->utime, ru->stime, ru->wait_ns / 1000, ru->nvcsw, ru->nivcsw);
+}
+
+/* SRC의 값들을 DST에 더한다. */
+static void
+rusage_add(struct cpu_usage *dst, const struct cpu_usage *src)
+{
+	dst->utime += src->utime;
+	dst->stime += src->stime;
+	dst->wait_ns += src->wait_ns;
+	dst->nvcsw += src->nvcsw;
+	dst->nivcsw += src->nivcsw;
+}
+
 /* Free the current process's resources. */
 static void
 process_cleanup(void)
@@ -905,7 +912,7 @@ lazy_load_segment(struct page *page, void *aux)
 	struct frame *frame = page->frame;
 	if (frame == NULL)
 	{
-		free(info);
+		kmem_cache_free(load_info_slab, info);
 		return false;
 	}
 	void *kva = frame->kva;
@@ -914,7 +921,7 @@ lazy_load_segment(struct page *page, void *aux)
 	file_seek(file, offset);
 	if (file_read(file, kva, read_bytes) != (int)read_bytes)
 	{
-		free(info);
+		kmem_cache_free(load_info_slab, info);
 		return false;
 	}
 
@@ -957,7 +964,7 @@ load_segment(struct file *file, off_t ofs, uint8_t *upage,
 
 		/* TODO: Set up aux to pass information to the lazy_load_segment. */
 		/* 로드를 위해 필요한 정보를 가진 load_info 구조체 만들었음*/
-		struct load_info *aux = (struct load_info *)malloc(sizeof(*aux));
+		struct load_info *aux = kmem_cache_alloc(load_info_slab);
 		if (aux == NULL)
 			return false;
 
@@ -970,7 +977,7 @@ load_segment(struct file *file, off_t ofs, uint8_t *upage,
 		if (!vm_alloc_page_with_initializer(VM_ANON, upage,
 											writable, lazy_load_segment, aux))
 		{
-			free(aux);
+			kmem_cache_free(load_info_slab, aux);
 			return false;
 		}
 
@@ -1,6 +1,8 @@
 #include "userprog/syscall.h"
 #include <stdio.h>
 #include <syscall-nr.h>
+#include <memstat.h>
+#include <rusage.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/loader.h"
@@ -37,10 +39,15 @@ int sys_write(int fd, const void *buffer, unsigned size);
 int sys_read(int fd, void *buffer, unsigned size);
 void sys_halt(void);
 int sys_dup2(int oldfd, int newfd);
+int sys_memstat(struct memstat *ms);
+int sys_settickets(int tickets);
+int sys_setrt(int budget, int period);
+int sys_getrusage(int who, struct rusage *ru);
 
 /* fd 할당/해제를 위한 함수 선언 */
 static int allocate_fd(struct file *f);
 static void free_fd(int fd);
+static struct file *fd_file(int fd);
 
 void *mmap(void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap(void *addr);
@@ -226,9 +233,9 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	case SYS_CLOSE:
 	{
 		int fd = (int)f->R.rdi;
-		if (fd > 1 && fd < MAX_FD && thread_current()->fd_table[fd])
+		if (fd > 1 && fd_file(fd))
 		{
-			file_close(thread_current()->fd_table[fd]);
+			file_close(fd_file(fd));
 
 			free_fd(fd);
 			f->R.rax = 0;
@@ -242,8 +249,8 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	{
 		int fd = (int)f->R.rdi;
 		struct file *fptr = NULL;
-		if (fd > 1 && fd < MAX_FD)
-			fptr = thread_current()->fd_table[fd];
+		if (fd > 1)
+			fptr = fd_file(fd);
 
 		f->R.rax = fptr ? (off_t)file_length(fptr) : -1;
 
@@ -255,8 +262,8 @@ void syscall_handler(struct intr_frame *f UNUSED)
 		int fd = (int)f->R.rdi;
 		unsigned pos = (unsigned)f->R.rsi;
 		struct file *fptr = NULL;
-		if (fd > 1 && fd < MAX_FD)
-			fptr = thread_current()->fd_table[fd];
+		if (fd > 1)
+			fptr = fd_file(fd);
 		if (fptr)
 		{
 			file_seek(fptr, pos);
@@ -269,8 +276,8 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	{
 		int fd = (int)f->R.rdi;
 		struct file *fptr = NULL;
-		if (fd > 1 && fd < MAX_FD)
-			fptr = thread_current()->fd_table[fd];
+		if (fd > 1)
+			fptr = fd_file(fd);
 
 		f->R.rax = fptr ? (unsigned)file_tell(fptr) : -1;
 
@@ -297,6 +304,36 @@ void syscall_handler(struct intr_frame *f UNUSED)
 		break;
 	}
 
+	case SYS_MEMSTAT:
+	{
+		f->R.rax = sys_memstat((struct memstat *)f->R.rdi);
+		break;
+	}
+
+	case SYS_SETTICKETS:
+	{
+		f->R.rax = sys_settickets(f->R.rdi);
+		break;
+	}
+
+	case SYS_SETRT:
+	{
+		f->R.rax = sys_setrt(f->R.rdi, f->R.rsi);
+		break;
+	}
+
+	case SYS_RTMISSES:
+	{
+		f->R.rax = thread_get_rt_misses();
+		break;
+	}
+
+	case SYS_GETRUSAGE:
+	{
+		f->R.rax = sys_getrusage(f->R.rdi, (struct rusage *)f->R.rsi);
+		break;
+	}
+
 	default:
 		sys_exit(-1);
 	}
@@ -372,9 +409,9 @@ int sys_write(int fd, const void *buffer, unsigned size)
 	// 1) 파일 디스크립터 테이블에 매핑된 파일이 있으면,
 	//    무조건 그 파일로 쓰기 (dup2로 덮어쓴 stdout 포함)
 	// 표준 출력 처리는 file_write에서 했음
-	if (fd >= 0 && fd < MAX_FD && thread_current()->fd_table[fd])
+	if (fd_file(fd))
 	{
-		ret = file_write(thread_current()->fd_table[fd], buffer, size);
+		ret = file_write(fd_file(fd), buffer, size);
 	}
 	else
 	{
@@ -405,14 +442,14 @@ int sys_read(int fd, void *buffer, unsigned size)
 	// 1) 파일 디스크립터 테이블에 매핑된 파일이 있으면,
 	//    무조건 그 파일로 쓰기 (dup2로 덮어쓴 stdin 포함)
 	// 표준 입력 처리는 file_read에서 했음
-	if (fd >= 0 && fd < MAX_FD && thread_current()->fd_table[fd])
+	if (fd_file(fd))
 	{
 		struct page *current_page = spt_find_page(&thread_current()->spt, buffer);
 		if (!current_page->writable)
 		{
 			sys_exit(-1);
 		}
-		ret = file_read(thread_current()->fd_table[fd], buffer, size);
+		ret = file_read(fd_file(fd), buffer, size);
 	}
 	else
 	{
@@ -431,53 +468,50 @@ int sys_dup2(int oldfd, int newfd)
 		return -1;
 
 	// oldfd가 열려 있지 않으면 실패(EBADF)
-	if (cur->fd_table[oldfd] == NULL)
+	if (fd_file(oldfd) == NULL)
 		return -1;
 
 	// fd 같으면 그냥 바로 리턴
 	if (oldfd == newfd)
 		return newfd;
 
-	// newfd 열려있다면 닫아주고
-	if (cur->fd_table[newfd] != NULL) // newfd가 열려있다면
-		file_close(cur->fd_table[newfd]);
+	// 테이블을 늘리다 실패할 수 있으니 newfd 칸부터 채우고,
+	// 그 다음에 참조를 올리고 원래 열려 있던 파일을 닫는다
+	struct file *file = fd_file(oldfd);
+	struct file *old = fd_file(newfd);
 
-	cur->fd_table[newfd] = file_dup2(cur->fd_table[oldfd]);
+	if (!thread_fd_set(cur, newfd, file))
+		return -1;
+	file_dup2(file);
+	file_close(old);
 
 	return newfd;
 }
 
-/* fd 할당 / 해제 헬퍼 함수*/
+/* fd 할당 / 해제 헬퍼 함수
+	allocate_fd : 가장 작은 빈 fd에 F를 넣는다 (비트맵으로 바로 찾음)
+	free_fd : fd 칸을 비운다
+	fd_file : fd에 열린 파일, 없거나 범위 밖이면 NULL
+*/
 static int allocate_fd(struct file *f)
 {
-	struct thread *cur = thread_current();
-	for (int fd = cur->next_fd; fd < MAX_FD; fd++)
-	{
-		if (cur->fd_table[fd] == NULL)
-		{
-			cur->fd_table[fd] = f;
-			cur->next_fd = fd + 1;
-			return fd;
-		}
-	}
-	return -1;
+	return thread_fd_alloc(thread_current(), f);
 }
 
 static void free_fd(int fd)
 {
-	struct thread *cur = thread_current();
-	cur->fd_table[fd] = NULL;
-	if (fd < cur->next_fd)
-		cur->next_fd = fd;
+	thread_fd_set(thread_current(), fd, NULL);
 }
 
-void *mmap(void *addr, size_t length, int writable, int fd, off_t offset)
+static struct file *fd_file(int fd)
 {
+	return thread_fd_get(thread_current(), fd);
+}
 
-	if (fd < 0 || fd >= MAX_FD || thread_current()->fd_table[fd] == NULL)
-		return NULL;
+void *mmap(void *addr, size_t length, int writable, int fd, off_t offset)
+{
 
-	struct file *file = thread_current()->fd_table[fd];
+	struct file *file = fd_file(fd);
 	if (file == NULL)
 		return NULL;
 
@@ -488,4 +522,49 @@ void munmap(void *addr)
 {
 	check_user_address(addr);
 	do_munmap(addr);
-}
\ No newline at end of file
+}
+/* 현재 프로세스의 메모리 사용량 통계를 유저 버퍼 MS에 복사한다.
+   성공하면 0, VM이 없는 커널이면 -1을 반환한다. */
+int sys_memstat(struct memstat *ms)
+{
+	check_user_buffer((char *)ms, sizeof *ms);
+#ifdef VM
+	memcpy(ms, &thread_current()->memstat, sizeof *ms);
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/* stride 스케줄러에서 현재 프로세스의 티켓 수를 TICKETS로 바꾼다.
+   성공하면 이전 티켓 수, 범위(1..TICKETS_MAX)를 벗어나면 -1. */
+int sys_settickets(int tickets)
+{
+	int old = thread_get_tickets();
+
+	if (!thread_set_tickets(tickets))
+		return -1;
+	return old;
+}
+
+/* 현재 프로세스가 PERIOD 틱마다 BUDGET 틱을 마감 순(EDF)으로 보장받도록
+   예약한다. BUDGET이 0이면 예약을 푼다. 성공하면 0, 인자가 잘못됐거나
+   예약 가능한 CPU 비율을 넘으면 -1. */
+int sys_setrt(int budget, int period)
+{
+	return thread_set_realtime(budget, period) ? 0 : -1;
+}
+
+/* 현재 프로세스(WHO == RUSAGE_SELF)나 종료한 자식들(RUSAGE_CHILDREN)의
+   CPU 사용량을 유저 버퍼 RU에 복사한다. 성공하면 0, WHO가 잘못됐으면 -1.
+   유저 페이지에 쓰다 폴트가 날 수 있으므로 커널 쪽 사본에서 복사한다. */
+int sys_getrusage(int who, struct rusage *ru)
+{
+	struct rusage usage;
+
+	check_user_buffer((char *)ru, sizeof *ru);
+	if (!thread_get_rusage(who, &usage))
+		return -1;
+	memcpy(ru, &usage, sizeof *ru);
+	return 0;
+}
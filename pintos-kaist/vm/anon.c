@@ -5,6 +5,7 @@
 #include "threads/vaddr.h"
 #include "kernel/bitmap.h"
 #include "threads/mmu.h"
+#include "vm/stats.h"
 
 /* 익명 페이지 스왑용 디스크와 슬롯 관리 */
 struct bitmap *swap_table;								   // 스왑 디스크의 각 슬롯(페이지 단위) 사용 여부를 관리하는 비트맵(비트 하나가 스왑슬롯 하나를 의미하며 0 : 비어있음, 1 : 사용중)
@@ -45,7 +46,7 @@ void vm_anon_init(void)
 }
 
 /* Initialize the file mapping */
-bool anon_initializer(struct page *page, enum vm_type type, void *kva)
+bool anon_initializer(struct page *page, enum vm_type type, void *kva UNUSED)
 {
 	/* Set up the handler */
 	page->operations = &anon_ops; // 익명페이지 전용 page_op 설정
@@ -55,8 +56,8 @@ bool anon_initializer(struct page *page, enum vm_type type, void *kva)
 	/* 스왑 슬롯 초기화 */
 	anon_page->swap_slot = -1;
 
-	/* 페이지 메모리 0으로 초기화 */
-	memset(kva, 0, PGSIZE);
+	/* 페이지 메모리는 vm_do_claim_page()가 필요할 때만 0으로 채운 프레임을 받아 온다.
+	   lazy load 되는 페이지는 초기화 함수가 전부 덮어쓰므로 여기서 지우지 않는다. */
 
 	return true;
 }
@@ -85,7 +86,11 @@ anon_swap_in(struct page *page, void *kva)
 	}
 
 	/* 4) 스왑 슬롯 해제 및 메타데이터 초기화 */
+	lock_acquire(&swap_lock);
 	bitmap_set(swap_table, anon_page->swap_slot, false); // 슬롯을 빈 상태로 되돌리고
+	thread_current()->memstat.swapped--;
+	vm_stats.swap_in_use--;
+	lock_release(&swap_lock);
 	page->anon.swap_slot = -1;							 // swap_slot 필드를 초기화
 
 	return true;
@@ -98,11 +103,21 @@ anon_swap_out(struct page *page)
 	struct anon_page *anon_page = &page->anon;
 
 	/* swap_table 비트맵을 순회해서 아직 사용되지 않은(0인) 슬롯을 찾아서 1로 표시 */
+	lock_acquire(&swap_lock);
 	int slot = bitmap_scan_and_flip(swap_table, 0, 1, false);
 	// printf("slot: %d\n", slot);
 	/* 만약 빈 슬롯이 없다면 실패(false)를 반환 */
 	if (slot == BITMAP_ERROR)
+	{
+		lock_release(&swap_lock);
 		return false;
+	}
+	/* 축출은 다른 프로세스가 할 수도 있으므로 프레임 주인의 통계에 반영 */
+	if (page->frame != NULL && page->frame->owner != NULL)
+		page->frame->owner->memstat.swapped++;
+	if (++vm_stats.swap_in_use > vm_stats.swap_peak)
+		vm_stats.swap_peak = vm_stats.swap_in_use;
+	lock_release(&swap_lock);
 
 	/*  “slot”번째 스왑 슬롯이 차지하는 디스크 내 첫 섹터 번호 계산
    - 한 슬롯은 SECTORS_PER_PAGE(페이지 크기/섹터 크기)개의 연속된 섹터로 구성
@@ -140,11 +155,40 @@ anon_destroy(struct page *page)
 {
 	struct anon_page *anon_page = &page->anon;
 
+	/* 스왑 디스크에 내려가 있던 페이지면 슬롯 반환
+	   (teardown 중에는 anon_swap_slots_release()가 이미 일괄 반환했다) */
+	if (anon_page->swap_slot >= 0)
+	{
+		lock_acquire(&swap_lock);
+		bitmap_reset(swap_table, anon_page->swap_slot);
+		thread_current()->memstat.swapped--;
+		vm_stats.swap_in_use--;
+		lock_release(&swap_lock);
+		anon_page->swap_slot = -1;
+	}
+
 	/* 물리 메모리에 올라와 있는 페이지가 있으면 해제 */
-	if (page->frame != NULL)
+	vm_free_frame(page);
+}
+
+/* 주소 공간 teardown 시 SPT에 있는 익명 페이지들의 스왑 슬롯을
+   swap_lock 한 번만 잡고 일괄 반환한다. */
+void anon_swap_slots_release(struct supplemental_page_table *spt)
+{
+	struct hash_iterator i;
+
+	lock_acquire(&swap_lock);
+	hash_first(&i, &spt->spt_hash);
+	while (hash_next(&i))
 	{
-		palloc_free_page(page->frame->kva);
+		struct page *p = hash_entry(hash_cur(&i), struct page, hash_elem);
+		if (p->operations == &anon_ops && p->anon.swap_slot >= 0)
+		{
+			bitmap_reset(swap_table, p->anon.swap_slot);
+			p->anon.swap_slot = -1;
+			vm_stats.swap_in_use--;
+		}
 	}
-	pml4_clear_page(thread_current()->pml4, page->va);
-	free(page->frame);
+	thread_current()->memstat.swapped = 0;
+	lock_release(&swap_lock);
 }
@@ -1,8 +1,13 @@
 /* file.c: Implementation of memory backed file object (mmaped object). */
 
 #include "vm/vm.h"
+#include <stdlib.h>
 #include "threads/vaddr.h"
 #include "threads/mmu.h"
+#include "threads/malloc.h"
+#include "threads/slab.h"
+#include "filesys/filesys.h"
+#include "vm/stats.h"
 
 static bool file_backed_swap_in(struct page *page, void *kva);
 static bool file_backed_swap_out(struct page *page);
@@ -41,21 +46,16 @@ lazy_load_mmap(struct page *page, void *aux)
 	uint32_t zero_bytes = info->zero_bytes;
 
 	/* 1) 이미 페이지에 매핑된 frame을 준비함 */
+	/* info(aux)는 페이지가 파괴될 때 file_backed_destroy()에서 해제된다. */
 	struct frame *frame = page->frame;
 	if (frame == NULL)
-	{
-		free(info);
 		return false;
-	}
 	void *kva = frame->kva;
 
 	/* 2) 파일 위치 설정 후, read_bytes만큼 읽어서 kva에 복사 */
 	file_seek(file, offset);
 	if (file_read(file, kva, read_bytes) != (int)read_bytes)
-	{
-		free(info);
 		return false;
-	}
 
 	/* 3) 나머지 부분(zero_bytes)만큼 0으로 채움 */
 	memset(kva + read_bytes, 0, zero_bytes);
@@ -101,6 +101,7 @@ file_backed_swap_out(struct page *page)
 	{
 		/* 수정된 페이지에 한에서 파일에 변경 내용을 기록한다. */
 		file_write_at(file_page, page->va, file_page->read_bytes, file_page->offset);
+		vm_stats.writebacks++;
 		/* 그 후 dirty비트를 초기화 한다*/
 		pml4_set_dirty(thread_current()->pml4, page->va, 0);
 	}
@@ -114,25 +115,87 @@ file_backed_swap_out(struct page *page)
 static void
 file_backed_destroy(struct page *page)
 {
-	// struct file_page *file_page UNUSED = &page->file;
-	struct file_page *file_page UNUSED = &page->file;
+	struct thread *curr = thread_current();
+	struct file_page *aux = page->uninit.aux;
 
-	if (pml4_is_dirty(thread_current()->pml4, page->va))
+	/* 수정된 페이지는 파일에 반영한다.
+	   teardown 중이면 file_backed_teardown()이 이미 일괄 writeback 했다. */
+	if (!curr->spt.teardown && page->frame != NULL && pml4_is_dirty(curr->pml4, page->va))
 	{
-		file_write_at(file_page->file, file_page->start_addr, file_page->read_bytes, file_page->offset);
-		pml4_set_dirty(thread_current()->pml4, page->va, false);
+		file_write_at(aux->file, page->frame->kva, aux->read_bytes, aux->offset);
+		vm_stats.writebacks++;
 	}
 
-	if (page->frame)
+	vm_free_frame(page);
+	kmem_cache_free(file_page_slab, aux);
+}
+
+/* writeback 정렬용 비교 함수: 같은 파일(inode)끼리, 오프셋 오름차순 */
+static int
+writeback_less(const void *a_, const void *b_)
+{
+	const struct page *a = *(const struct page **)a_;
+	const struct page *b = *(const struct page **)b_;
+	const struct file_page *fa = a->uninit.aux;
+	const struct file_page *fb = b->uninit.aux;
+	struct inode *ia = file_get_inode(fa->file);
+	struct inode *ib = file_get_inode(fb->file);
+
+	if (ia != ib)
+		return ia < ib ? -1 : 1;
+	return fa->offset < fb->offset ? -1 : fa->offset > fb->offset;
+}
+
+/* 주소 공간 teardown용: dirty한 file-backed 페이지를 모아 (파일, 오프셋) 순으로
+ * 정렬한 뒤 filesys_lock 한 번 아래에서 연속으로 writeback 하고,
+ * 각 mmap 매핑이 잡고 있던 파일 핸들을 닫는다. */
+void file_backed_teardown(struct supplemental_page_table *spt, uint64_t *pml4)
+{
+	struct hash_iterator i;
+	struct page **dirty;
+	size_t dirty_cnt = 0;
+
+	/* 정렬용 배열을 못 얻으면 정렬 없이 해시 순서대로 쓴다 */
+	dirty = malloc(sizeof *dirty * hash_size(&spt->spt_hash));
+
+	lock_acquire(&filesys_lock);
+	hash_first(&i, &spt->spt_hash);
+	while (hash_next(&i))
 	{
-		list_remove(&page->frame->frame_elem);
-		page->frame->page = NULL;
-		free(page->frame);
-		page->frame = NULL;
+		struct page *p = hash_entry(hash_cur(&i), struct page, hash_elem);
+		struct file_page *aux = p->uninit.aux;
+
+		if (p->operations != &file_ops || p->frame == NULL || !pml4_is_dirty(pml4, p->va))
+			continue;
+		if (dirty != NULL)
+			dirty[dirty_cnt++] = p;
+		else
+			file_write_at(aux->file, p->frame->kva, aux->read_bytes, aux->offset);
+		vm_stats.writebacks++;
 	}
 
-	pml4_clear_page(thread_current()->pml4, page->va);
-	hash_delete(&thread_current()->spt.spt_hash, &page->hash_elem);
+	if (dirty != NULL)
+	{
+		qsort(dirty, dirty_cnt, sizeof *dirty, writeback_less);
+		for (size_t k = 0; k < dirty_cnt; k++)
+		{
+			struct file_page *aux = dirty[k]->uninit.aux;
+			file_write_at(aux->file, dirty[k]->frame->kva, aux->read_bytes, aux->offset);
+		}
+	}
+	lock_release(&filesys_lock);
+	free(dirty);
+
+	/* 매핑마다 do_mmap()에서 file_reopen()한 핸들을 첫 페이지 기준으로 한 번씩 닫는다 */
+	hash_first(&i, &spt->spt_hash);
+	while (hash_next(&i))
+	{
+		struct page *p = hash_entry(hash_cur(&i), struct page, hash_elem);
+		struct file_page *aux = p->uninit.aux;
+
+		if (page_get_type(p) == VM_FILE && p->va == aux->start_addr)
+			file_close(aux->file);
+	}
 }
 
 /* Do the mmap */
@@ -181,7 +244,7 @@ do_mmap(void *addr, size_t length, int writable, struct file *file, off_t offset
 		/* TODO: Set up aux to pass information to the lazy_load_segment. */
 		/*  aux 할당 및 초기화와
 			로드를 위해 필요한 정보를 가진 file_page 구조체 만들었음*/
-		struct file_page *aux = (struct file_page *)malloc(sizeof(*aux));
+		struct file_page *aux = kmem_cache_alloc(file_page_slab);
 		if (aux == NULL)
 			return NULL;
 
@@ -198,7 +261,7 @@ do_mmap(void *addr, size_t length, int writable, struct file *file, off_t offset
 		if (!vm_alloc_page_with_initializer(VM_FILE, addr,
 											writable, lazy_load_mmap, aux))
 		{
-			free(aux);
+			kmem_cache_free(file_page_slab, aux);
 			file_close(file_cp);
 			return NULL;
 		}
@@ -217,50 +280,27 @@ do_mmap(void *addr, size_t length, int writable, struct file *file, off_t offset
 /* Do the munmap */
 void do_munmap(void *addr)
 {
-	struct thread *cur = thread_current();
+	struct supplemental_page_table *spt = &thread_current()->spt;
 
 	addr = pg_round_down(addr);
 
-	/* 첫 페이지에서 file 핸들 꺼내기 */
-	struct page *page = spt_find_page(&cur->spt, addr);
-	if (!page)
+	/* 첫 페이지에서 file 핸들과 매핑 시작 주소 꺼내기 */
+	struct page *page = spt_find_page(spt, addr);
+	if (page == NULL || page_get_type(page) != VM_FILE)
 		return;
 	struct file_page *first_aux = (struct file_page *)page->uninit.aux;
 	struct file *file = first_aux->file;
+	void *start_addr = first_aux->start_addr;
 
-	while (true)
+	/* 같은 매핑에 속한 페이지만 SPT에서 제거한다.
+	   수정된 페이지의 writeback, 매핑 해제, 프레임/aux 반납은 file_backed_destroy()가 한다. */
+	while (page != NULL && page_get_type(page) == VM_FILE && ((struct file_page *)page->uninit.aux)->start_addr == start_addr)
 	{
-		/* 매핑 정보 조회*/
-		struct page *page = spt_find_page(&thread_current()->spt, addr);
-		if (page == NULL)
-			break;
-
-		struct file_page *aux = (struct file_page *)page->uninit.aux;
-
-		/* 수정된 페이지(dirty bit == 1)는 파일에 업데이트해놓는다. 이후에 dirty bit을 0으로 만든다. */
-		if (pml4_is_dirty(thread_current()->pml4, page->va)) //	pml4_is_dirty함수는 페이지의 dirty bit이 1이면 true를, 0이면 false를 리턴한다.
-		{
-			/* 물리 프레임에 변경된 데이터를 다시 디스크 파일에 업데이트해주는 함수. buffer에 있는 데이터를 size만큼, file의 file_ofs부터 써준다 */
-			file_write_at(aux->file, page->frame->kva, aux->read_bytes, aux->offset);
-			/* 인자로 받은 dirty의 값이 1이면 page의 dirty bit을 1로, 0이면 0으로 변경해준다. */
-			pml4_set_dirty(thread_current()->pml4, page->va, 0);
-		}
-		/* pml4 페이지 안에서 va와 매핑된거 지우는 함수 */
-		pml4_clear_page(thread_current()->pml4, page->va);
-
-		/* c) physical frame 해제 */
-		// if (page->frame)
-		// {
-		// 	palloc_free_page(page->frame->kva);
-		// 	free(page->frame);
-		// }
-
-		/* d) SPT 엔트리 & aux 해제 */
-		// spt_remove_page(&cur->spt, page);
-		// free(aux);
-
+		spt_remove_page(spt, page);
 		addr += PGSIZE;
+		page = spt_find_page(spt, addr);
 	}
-	/* 4) 파일 닫기 */
+
+	/* 파일 닫기 */
 	file_close(file);
 }
@@ -0,0 +1,59 @@
+/* stats.c: VM event counters and latency histograms. */
+
+#include "vm/stats.h"
+#include <stdio.h>
+
+struct vm_stats vm_stats;
+
+static const char *fault_names[VM_FAULT_CNT] = {
+	[VM_FAULT_ELF] = "elf",
+	[VM_FAULT_ZERO] = "zero",
+	[VM_FAULT_MMAP] = "mmap",
+	[VM_FAULT_STACK] = "stack",
+	[VM_FAULT_SWAP_IN] = "swap-in",
+	[VM_FAULT_WP] = "write-protect",
+};
+
+/* CYCLES를 HIST의 log2 구간에 기록한다. */
+void vm_hist_add(struct vm_hist *hist, uint64_t cycles)
+{
+	int k = 0;
+
+	while (k < VM_HIST_BUCKETS - 1 && (cycles >> (k + 1)) != 0)
+		k++;
+
+	hist->cnt++;
+	hist->sum += cycles;
+	if (cycles > hist->max)
+		hist->max = cycles;
+	hist->bucket[k]++;
+}
+
+/* 비어 있지 않은 구간만 출력한다. */
+static void
+hist_print(const char *name, const struct vm_hist *hist)
+{
+	if (hist->cnt == 0)
+		return;
+
+	printf("VM: %s latency: %llu samples, mean %llu, max %llu cycles\n",
+		   name, hist->cnt, hist->sum / hist->cnt, hist->max);
+	for (int k = 0; k < VM_HIST_BUCKETS; k++)
+		if (hist->bucket[k] != 0)
+			printf("VM:   < 2^%-2d cycles: %llu\n", k + 1, hist->bucket[k]);
+}
+
+/* Prints VM statistics. */
+void vm_print_stats(void)
+{
+	printf("VM: faults");
+	for (int i = 0; i < VM_FAULT_CNT; i++)
+		printf(" %s=%llu", fault_names[i], vm_stats.faults[i]);
+	printf("\n");
+	printf("VM: evictions anon=%llu file=%llu, %llu writebacks\n",
+		   vm_stats.evict_anon, vm_stats.evict_file, vm_stats.writebacks);
+	printf("VM: swap slots %llu in use, %llu peak\n",
+		   vm_stats.swap_in_use, vm_stats.swap_peak);
+	hist_print("fault", &vm_stats.fault_lat);
+	hist_print("evict", &vm_stats.evict_lat);
+}
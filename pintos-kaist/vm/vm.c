@@ -1,8 +1,13 @@
 /* vm.c: Generic interface for virtual memory objects. */
 
+#include <stdio.h>
+#include <string.h>
 #include "threads/malloc.h"
+#include "threads/slab.h"
 #include "vm/vm.h"
 #include "vm/inspect.h"
+#include "vm/stats.h"
+#include "intrinsic.h"
 
 #include "threads/vaddr.h"
 #include "threads/synch.h"
@@ -13,6 +18,15 @@ static struct list frame_table;
 /* frame_list에 대한 동기화를 위한 락 */
 static struct lock frame_table_lock;
 
+/* -memstat 부트 옵션: 프로세스 종료 시 메모리 통계를 출력한다 */
+bool memstat_at_exit;
+
+/* 자주 할당되는 VM 객체들의 전용 캐시.
+ * malloc()은 2의 거듭제곱으로 올려 잡아 struct page 같은 객체에서 공간을 낭비한다. */
+static struct kmem_cache *page_slab;
+static struct kmem_cache *frame_slab;
+struct kmem_cache *file_page_slab;
+
 /* Initializes the virtual memory subsystem by invoking each subsystem's
  * intialize codes. */
 void vm_init(void)
@@ -28,6 +42,12 @@ void vm_init(void)
 	// frame_table 초기화 함수 추가
 	list_init(&frame_table);
 	lock_init(&frame_table_lock);
+
+	page_slab = kmem_cache_create("page", sizeof(struct page), NULL);
+	frame_slab = kmem_cache_create("frame", sizeof(struct frame), NULL);
+	file_page_slab = kmem_cache_create("file_page", sizeof(struct file_page), NULL);
+	if (page_slab == NULL || frame_slab == NULL || file_page_slab == NULL)
+		PANIC("cannot create VM object caches");
 }
 
 /* Get the type of the page. This function is useful if you want to know the
@@ -46,6 +66,55 @@ page_get_type(struct page *page)
 	}
 }
 
+/* FRAME의 주인 프로세스 상주 페이지 수에 DELTA를 더한다.
+ * 주인 외의 스레드(축출)도 갱신하므로 frame_table_lock을 잡고 호출해야 한다. */
+static void
+frame_account(struct frame *frame, int delta)
+{
+	struct memstat *ms;
+
+	ASSERT(lock_held_by_current_thread(&frame_table_lock));
+	if (frame->owner == NULL || frame->page == NULL)
+		return;
+	ms = &frame->owner->memstat;
+	ms->rss += delta;
+	if (page_get_type(frame->page) == VM_FILE)
+		ms->file_pages += delta;
+}
+
+/* PAGE를 메모리에 올리는 데 디스크 I/O가 필요한지(major fault) 판단한다.
+ * 스왑에서 읽거나 파일에서 읽어야 하면 true, 0으로 채우기만 하면 false. */
+static bool
+page_needs_io(struct page *page)
+{
+	switch (VM_TYPE(page->operations->type))
+	{
+	case VM_UNINIT:
+		return page->uninit.init != NULL;
+	case VM_ANON:
+		return page->anon.swap_slot >= 0;
+	default:
+		return true;
+	}
+}
+
+/* 통계용: PAGE를 올리는 폴트의 종류를 판단한다. */
+static enum vm_fault_kind
+page_fault_kind(struct page *page)
+{
+	enum vm_type type = VM_TYPE(page->operations->type);
+
+	if (type == VM_UNINIT)
+	{
+		if (VM_TYPE(page->uninit.type) == VM_FILE)
+			return VM_FAULT_MMAP;
+		return page->uninit.init != NULL ? VM_FAULT_ELF : VM_FAULT_ZERO;
+	}
+	if (type == VM_ANON)
+		return page->anon.swap_slot >= 0 ? VM_FAULT_SWAP_IN : VM_FAULT_ZERO;
+	return VM_FAULT_MMAP;
+}
+
 /* Helpers */
 static struct frame *vm_get_victim(void);
 static bool vm_do_claim_page(struct page *page);
@@ -71,7 +140,7 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage, bool writabl
 		/* TODO: Create the page, fetch the initialier according to the VM type,
 		 * TODO: and then create "uninit" page struct by calling uninit_new. You
 		 * TODO: should modify the field after calling the uninit_new. */
-		struct page *page = (struct page *)malloc(sizeof *page);
+		struct page *page = kmem_cache_alloc(page_slab);
 		if (page == NULL)
 			return false;
 
@@ -87,7 +156,7 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage, bool writabl
 			page_initializer = file_backed_initializer;
 			break;
 		default:
-			free(page);
+			kmem_cache_free(page_slab, page);
 			return false;
 		}
 		uninit_new(page, va, init, type, aux, page_initializer);
@@ -97,7 +166,7 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage, bool writabl
 		/* TODO: Insert the page into the spt. */
 		if (!spt_insert_page(spt, page))
 		{
-			free(page);
+			kmem_cache_free(page_slab, page);
 			return false;
 		}
 		return true;
@@ -210,15 +279,22 @@ vm_get_victim(void)
 /* Evict one page and return the corresponding frame.
  * Return NULL on error.*/
 static struct frame *
-vm_evict_frame(void)
+vm_do_evict_frame(void)
 {
 	lock_acquire(&frame_table_lock);
 	struct frame *victim = vm_get_victim();
+	if (victim != NULL)
+		frame_account(victim, -1);
 	lock_release(&frame_table_lock);
 	/* TODO: swap out the victim and return the evicted frame. */
 	if (victim == NULL)
 		return NULL;
 
+	if (page_get_type(victim->page) == VM_FILE)
+		vm_stats.evict_file++;
+	else
+		vm_stats.evict_anon++;
+
 	/* victim이 차지하고 있는 페이지가 있다면 swap_out*/
 	if (!swap_out(victim->page))
 		return NULL;
@@ -227,23 +303,36 @@ vm_evict_frame(void)
 	return victim;
 }
 
+/* 축출 소요 시간을 기록하는 vm_do_evict_frame()의 래퍼 */
+static struct frame *
+vm_evict_frame(void)
+{
+	uint64_t start = rdtsc();
+	struct frame *victim = vm_do_evict_frame();
+
+	vm_hist_add(&vm_stats.evict_lat, rdtsc() - start);
+	return victim;
+}
+
 /* palloc() and get frame. If there is no available page, evict the page
  * and return it. This always return valid address. That is, if the user pool
  * memory is full, this function evicts the frame to get the available memory
- * space.*/
+ * space.
+ * FLAGS에 PAL_ZERO가 있으면 0으로 채운 프레임을 준다. palloc의 미리 0으로
+ * 채워 둔 페이지를 먼저 쓰고, 축출한 프레임이면 직접 채운다. */
 static struct frame *
-vm_get_frame(void)
+vm_get_frame(enum palloc_flags flags)
 {
 
 	struct frame *frame = NULL;
 	/* TODO: Fill this function. */
 
 	/* 1) 빈 유저 페이지가 있는지 할당 시도 <- 빈 물리 페이지를 할당*/
-	void *kva = palloc_get_page(PAL_USER);
+	void *kva = palloc_get_page(PAL_USER | flags);
 	if (kva != NULL)
 	{
-		/* 받아온 kva를 관리할 struct frame을 malloc <- 프레임 테이블 위함 */
-		frame = (struct frame *)malloc(sizeof(struct frame));
+		/* 받아온 kva를 관리할 struct frame을 할당 <- 프레임 테이블 위함 */
+		frame = kmem_cache_alloc(frame_slab);
 		if (frame == NULL)
 		{
 			palloc_free_page(kva);
@@ -252,6 +341,7 @@ vm_get_frame(void)
 		/* 새 프레임 내부 필드 초기화 */
 		frame->kva = kva;	/* 실제 물리 페이지의 커널 가상 주소 */
 		frame->page = NULL; /* 아직 어떤 SPTE와도 매핑되지 않은 상태 */
+		frame->owner = NULL;
 
 		lock_acquire(&frame_table_lock);
 		list_push_back(&frame_table, &frame->frame_elem);
@@ -273,6 +363,8 @@ vm_get_frame(void)
 		return NULL;
 	}
 	victim->page = NULL;
+	if (flags & PAL_ZERO)
+		memset(victim->kva, 0, PGSIZE);
 
 	ASSERT(victim != NULL);
 	ASSERT(victim->page == NULL);
@@ -300,8 +392,9 @@ vm_handle_wp(struct page *page UNUSED)
 }
 
 /* Return true on success */
-bool vm_try_handle_fault(struct intr_frame *f, void *addr,
-						 bool user, bool write, bool not_present)
+static bool
+vm_do_handle_fault(struct intr_frame *f, void *addr,
+				   bool user, bool write, bool not_present)
 {
 	struct supplemental_page_table *spt UNUSED = &thread_current()->spt;
 	struct page *page = NULL;
@@ -354,6 +447,8 @@ bool vm_try_handle_fault(struct intr_frame *f, void *addr,
 						break;
 					/* 스택 확장 시도 */
 					vm_stack_growth(next_page);
+					thread_current()->memstat.minor_faults++;
+					vm_stats.faults[VM_FAULT_STACK]++;
 					stack_bottom = next_page;
 					/* 확장 후 최하단 경계 갱신 */
 					thread_current()->stack_bottom = fault_page;
@@ -369,12 +464,41 @@ bool vm_try_handle_fault(struct intr_frame *f, void *addr,
 		if (page != NULL)
 		{
 			if (write && !page->writable)
+			{
+				vm_stats.faults[VM_FAULT_WP]++;
+				return false;
+			}
+
+			struct memstat *ms = &thread_current()->memstat;
+			bool major = page_needs_io(page);
+			enum vm_fault_kind kind = page_fault_kind(page);
+			if (!vm_do_claim_page(page))
 				return false;
-			return vm_do_claim_page(page);
+			vm_stats.faults[kind]++;
+			if (major)
+				ms->major_faults++;
+			else
+				ms->minor_faults++;
+			return true;
 		}
 
 		return false;
 	}
+
+	/* present 페이지에 대한 폴트는 쓰기 보호 위반 */
+	vm_stats.faults[VM_FAULT_WP]++;
+	return false;
+}
+
+/* 폴트 처리 소요 시간을 기록하는 vm_do_handle_fault()의 래퍼 */
+bool vm_try_handle_fault(struct intr_frame *f, void *addr,
+						 bool user, bool write, bool not_present)
+{
+	uint64_t start = rdtsc();
+	bool success = vm_do_handle_fault(f, addr, user, write, not_present);
+
+	vm_hist_add(&vm_stats.fault_lat, rdtsc() - start);
+	return success;
 }
 
 /* Free the page.
@@ -382,7 +506,34 @@ bool vm_try_handle_fault(struct intr_frame *f, void *addr,
 void vm_dealloc_page(struct page *page)
 {
 	destroy(page);
-	free(page);
+	kmem_cache_free(page_slab, page);
+}
+
+/* PAGE에 연결된 프레임을 반납한다.
+ * 평소에는 frame_table에서 떼어내고 매핑을 지운 뒤 물리 페이지를 돌려주지만,
+ * 주소 공간 teardown 중이면 frame_table에서는 이미 일괄 분리되었고
+ * 물리 페이지는 곧 pml4_destroy()가 페이지 테이블을 훑으며 함께 해제하므로
+ * struct frame만 해제한다. */
+void vm_free_frame(struct page *page)
+{
+	struct thread *curr = thread_current();
+	struct frame *frame = page->frame;
+
+	if (frame == NULL)
+		return;
+
+	if (!curr->spt.teardown)
+	{
+		lock_acquire(&frame_table_lock);
+		list_remove(&frame->frame_elem);
+		frame_account(frame, -1);
+		lock_release(&frame_table_lock);
+
+		pml4_clear_page(curr->pml4, page->va);
+		palloc_free_page(frame->kva);
+	}
+	kmem_cache_free(frame_slab, frame);
+	page->frame = NULL;
 }
 
 /* Claim the page that allocate on VA. */
@@ -413,12 +564,20 @@ bool vm_claim_page(void *va)
 static bool
 vm_do_claim_page(struct page *page)
 {
-	struct frame *frame = vm_get_frame();
+	/* 초기화 함수가 없는 익명 페이지(스택 등)만 0으로 시작해야 한다.
+	   lazy_load_segment()나 파일, 스왑에서 채우는 페이지는 어차피 덮어쓴다. */
+	bool zero = page->operations->type == VM_UNINIT && page->uninit.init == NULL && VM_TYPE(page->uninit.type) == VM_ANON;
+	struct frame *frame = vm_get_frame(zero ? PAL_ZERO : 0);
 
 	/* Set links */
 	frame->page = page;
 	page->frame = frame;
 
+	lock_acquire(&frame_table_lock);
+	frame->owner = thread_current();
+	frame_account(frame, 1);
+	lock_release(&frame_table_lock);
+
 	/* TODO: Insert page table entry to map page's VA to frame's PA. */
 	/* 가상 주소와 물리 주소를 매핑 */
 	pml4_set_page(thread_current()->pml4, page->va, frame->kva, page->writable);
@@ -449,6 +608,7 @@ void supplemental_page_table_init(struct supplemental_page_table *spt)
 {
 	// 해시 테이블 초기화
 	hash_init(&spt->spt_hash, page_hash, page_less, NULL);
+	spt->teardown = false;
 }
 
 /* Copy supplemental page table from src to dst */
@@ -498,7 +658,7 @@ bool supplemental_page_table_copy(struct supplemental_page_table *dst,
 		else if (type == VM_FILE)
 		{
 			struct file_page *f = &src_page->file;
-			struct file_page *aux = malloc(sizeof(*aux));
+			struct file_page *aux = kmem_cache_alloc(file_page_slab);
 			if (!aux)
 				return false;
 
@@ -530,19 +690,62 @@ bool supplemental_page_table_copy(struct supplemental_page_table *dst,
 void hash_page_destroy(struct hash_elem *e, void *aux)
 {
 	struct page *p = hash_entry(e, struct page, hash_elem);
-	/* 이 한 줄로 프레임 해제, 스왑 슬롯 반환, aux free, 그리고 free(p)까지 수행 */
+	/* 이 한 줄로 프레임 해제, 스왑 슬롯 반환, aux 해제, 그리고 p 해제까지 수행 */
 	// vm_dealloc_page(p);
 
 	destroy(p);
-	free(p);
+	kmem_cache_free(page_slab, p);
 }
 
 /* Free the resource hold by the supplemental page table */
+/* 주소 공간 전체를 한 번에 내리는 fast path.
+ * process_cleanup()에서 이 함수 직후 pml4를 통째로 파괴하므로(CR3 재적재로 TLB도 비워짐)
+ * 페이지마다 pml4_clear_page()와 invlpg를 할 필요가 없다.
+ * 매핑되어 있던 물리 프레임 역시 pml4_destroy()가 페이지 테이블을 훑으며 해제한다.
+ * 호출자는 반드시 곧바로 현재 스레드의 pml4를 파괴해야 한다. */
 void supplemental_page_table_kill(struct supplemental_page_table *spt)
 {
 	/* TODO: Destroy all the supplemental_page_table hold by thread and
 	 * TODO: writeback all the modified contents to the storage. */
+	struct hash_iterator i;
+
+	/* 커널 스레드이거나 이미 비워진 spt */
+	if (hash_empty(&spt->spt_hash))
+		return;
 
-	// 버킷 배열 메모리 자체를 해제
+	spt->teardown = true;
+
+	/* 1) dirty file-backed 페이지를 모아서 한 번에 writeback, mmap 파일 닫기 */
+	file_backed_teardown(spt, thread_current()->pml4);
+
+	/* 2) frame_table 락은 한 번만 잡고 이 프로세스의 프레임을 모두 떼어낸다 */
+	lock_acquire(&frame_table_lock);
+	hash_first(&i, &spt->spt_hash);
+	while (hash_next(&i))
+	{
+		struct page *p = hash_entry(hash_cur(&i), struct page, hash_elem);
+		if (p->frame != NULL)
+			list_remove(&p->frame->frame_elem);
+	}
+	thread_current()->memstat.rss = 0;
+	thread_current()->memstat.file_pages = 0;
+	lock_release(&frame_table_lock);
+
+	/* 3) 스왑 슬롯도 swap_lock 한 번으로 일괄 반환 */
+	anon_swap_slots_release(spt);
+
+	/* 4) 남은 struct page / struct frame / aux 해제 (버킷 배열은 exec에서 재사용) */
 	hash_clear(&spt->spt_hash, hash_page_destroy);
+
+	spt->teardown = false;
+}
+
+/* T의 메모리 사용량 통계를 출력한다 (-memstat). */
+void memstat_print(struct thread *t)
+{
+	struct memstat *ms = &t->memstat;
+
+	printf("%s: memstat rss=%llu file=%llu swap=%llu cow=%llu minflt=%llu majflt=%llu\n",
+		   t->name, ms->rss, ms->file_pages, ms->swapped, ms->cow_shared,
+		   ms->minor_faults, ms->major_faults);
 }